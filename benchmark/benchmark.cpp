@@ -0,0 +1,129 @@
+#include <Evaluator.hpp>
+#include <ce/Expression.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace evaluate;
+using namespace std;
+
+// evaluations per second of every backend for some typical expressions,
+// build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers
+struct Case {
+    string expression;
+    vector<string> variables;
+    vector<ValueType> types;
+};
+
+static double nanoseconds(Evaluator& evaluator, size_t variables) {
+    constexpr size_t evaluations = 200000;
+    vector<variant<int64_t, double>> values(variables);
+    double sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < evaluations; ++i) {
+        for (size_t k = 0; k < variables; ++k) {
+            values[k] = k % 2 ? variant<int64_t, double>(static_cast<int64_t>(i % 64 + 1)) :
+                                variant<int64_t, double>(0.001 * static_cast<double>(i % 1000));
+        }
+        auto result = evaluator.get(values);
+        sink += holds_alternative<double>(result) ? std::get<double>(result) :
+                                                    static_cast<double>(std::get<int64_t>(result));
+    }
+    auto time = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    if (sink == 0.5) {
+        printf(" ");
+    }
+    return time / evaluations;
+}
+
+// the same for an expression template called with a double d and an integer i for the variables
+template <typename F> static double nanoseconds(F f) {
+    constexpr size_t evaluations = 200000;
+    double sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < evaluations; ++i) {
+        sink += f(0.001 * static_cast<double>(i % 1000), static_cast<int64_t>(i % 64 + 1));
+    }
+    auto time = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    if (sink == 0.5) {
+        printf(" ");
+    }
+    return time / evaluations;
+}
+
+// nanoseconds per row of a long double chain evaluated on columns of rows rows
+static double nanoseconds(Evaluator& evaluator, const vector<Column>& columns, size_t rows) {
+    constexpr size_t evaluations = 2000;
+    double sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < evaluations; ++i) {
+        sink += std::get<vector<double>>(evaluator.get(columns, rows))[i % rows];
+    }
+    auto time = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    if (sink == 0.5) {
+        printf(" ");
+    }
+    return time / static_cast<double>(evaluations * rows);
+}
+
+int main() {
+    vector<Case> cases{
+        {"x * exp(-r * t) + n * 3 - r / 4", {"x", "n", "r", "t"}, {}},
+        {"x * exp(-r * t) + n * 3 - r / 4",
+         {"x", "n", "r", "t"},
+         {ValueType::floating, ValueType::integer, ValueType::floating, ValueType::floating}},
+        {"(n * n + 3 * n - 7) % 1000 + (n << 2) ^ (n >> 1)", {"x", "n"}, {}},
+        {"2.5 * (x ** 3) + 1.5 * (x ** 2) - 4 * x + 7 + x * x * n - x / 3",
+         {"x", "n"},
+         {ValueType::floating, ValueType::integer}},
+    };
+    printf("%-70s %10s %10s %10s\n", "expression", "tree", "bytecode", "jit");
+    for (auto& c : cases) {
+        Evaluator tree(c.expression, c.variables, {}, c.types);
+        Evaluator bytecode(c.expression, c.variables, {.backend = Backend::bytecode}, c.types);
+        Evaluator jit(c.expression, c.variables, {.backend = Backend::jit}, c.types);
+        string name = c.expression + (c.types.empty() ? "" : " (typed)");
+        printf("%-70s %8.1fns %8.1fns %8.1fns\n", name.c_str(),
+               nanoseconds(tree, c.variables.size()), nanoseconds(bytecode, c.variables.size()),
+               nanoseconds(jit, c.variables.size()));
+    }
+    auto decay = compile<"x * exp(-r * t) + n * 3 - r / 4">();
+    auto polynomial = compile<"2.5 * (x ** 3) + 1.5 * (x ** 2) - 4 * x + 7 + x * x * n - x / 3">();
+    printf("\n%-70s %10s\n", "expression", "compile<>");
+    printf("%-70s %8.1fns\n", "x * exp(-r * t) + n * 3 - r / 4",
+           nanoseconds([&](double d, int64_t i) { return decay(d, i, d, i); }));
+    printf("%-70s %8.1fns\n", "2.5 * (x ** 3) + 1.5 * (x ** 2) - 4 * x + 7 + x * x * n - x / 3",
+           nanoseconds([&](double d, int64_t i) { return polynomial(d, i); }));
+
+    // a machine-generated sum of 64 doubles, which FloatPolicy::fast rebalances
+    constexpr size_t terms = 64;
+    constexpr size_t rows = 4096;
+    string chain;
+    vector<string> variables;
+    vector<Column> columns;
+    for (size_t k = 0; k < terms; ++k) {
+        variables.emplace_back(1, 'x');
+        variables.back() += to_string(k);
+        chain += k ? " + " : "";
+        chain += variables.back();
+        vector<double> column(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            column[i] = 0.001 * static_cast<double>((i * terms + k) % 1000);
+        }
+        columns.emplace_back(move(column));
+    }
+    vector<ValueType> types(terms, ValueType::floating);
+    printf("\n%-70s %10s %10s %10s %10s\n", "64-term double sum", "tree", "bytecode", "jit",
+           "columns");
+    for (FloatPolicy fp : {FloatPolicy::strict, FloatPolicy::fast}) {
+        Evaluator tree(chain, variables, {.fp = fp}, types);
+        Evaluator bytecode(chain, variables, {.fp = fp, .backend = Backend::bytecode}, types);
+        Evaluator jit(chain, variables, {.fp = fp, .backend = Backend::jit}, types);
+        string name = "fp=" + string(evaluate::name(fp));
+        printf("%-70s %8.1fns %8.1fns %8.1fns %8.2fns\n", name.c_str(), nanoseconds(tree, terms),
+               nanoseconds(bytecode, terms), nanoseconds(jit, terms),
+               nanoseconds(tree, columns, rows));
+    }
+    return 0;
+}
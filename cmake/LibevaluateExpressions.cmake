@@ -0,0 +1,25 @@
+# libevaluate_add_expressions(<target> <file> [NAMESPACE <namespace>] [OPTIONS <option>...])
+#
+# generates <file name>.hpp with a C++ function for every expression of file at build time and
+# makes it includable by target, which has to link libevaluate_core. OPTIONS are passed to
+# libevaluate_generate, e.g. --fp=fast
+function(libevaluate_add_expressions target file)
+    cmake_parse_arguments(ARG "" "NAMESPACE" "OPTIONS" ${ARGN})
+    if(NOT ARG_NAMESPACE)
+        set(ARG_NAMESPACE expressions)
+    endif()
+    get_filename_component(input ${file} ABSOLUTE)
+    get_filename_component(name ${file} NAME_WE)
+    set(directory ${CMAKE_CURRENT_BINARY_DIR}/libevaluate_expressions/${target})
+    set(output ${directory}/${name}.hpp)
+    add_custom_command(
+            OUTPUT ${output}
+            COMMAND ${CMAKE_COMMAND} -E make_directory ${directory}
+            COMMAND libevaluate_generate ${input} ${output} --namespace=${ARG_NAMESPACE}
+            ${ARG_OPTIONS}
+            DEPENDS libevaluate_generate ${input}
+            COMMENT "Generating ${name}.hpp from ${file}"
+            VERBATIM)
+    target_sources(${target} PRIVATE ${output})
+    target_include_directories(${target} PRIVATE ${directory})
+endfunction()
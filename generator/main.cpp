@@ -0,0 +1,185 @@
+#include <Evaluator.hpp>
+#include <aot/CodeGenerator.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <util/Error.hpp>
+#include <vector>
+
+using namespace evaluate;
+using namespace std;
+
+// generates a header with a C++ function for every expression of a file, see readme.md.
+// usage: libevaluate_generate <input> <output> [--namespace=ns] [--accuracy=..] [--overflow=..]
+//        [--fp=..] [--level=..]
+// every line of the input is a declaration like "name(x: floating, n: integer, a) = expression",
+// variables without a type can have any type, # starts a comment
+
+static string trim(string_view s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == string_view::npos) {
+        return {};
+    }
+    return string(s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1));
+}
+
+static bool isIdentifier(const string& s) {
+    if (s.empty() || isdigit(static_cast<unsigned char>(s[0]))) {
+        return false;
+    }
+    for (char c : s) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the keywords and alternative tokens of C++, the types the generated code names and identifiers
+// reserved for the implementation or the generated locals, which start with an underscore
+static bool isReserved(const string& s) {
+    static const array<string_view, 94> reserved{
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+        "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept",
+        "const", "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await",
+        "co_return", "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+        "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+        "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+        "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+        "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local",
+        "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+        "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq", "int64_t", "uint64_t"};
+    return s[0] == '_' || s.find("__") != string::npos ||
+           find(reserved.begin(), reserved.end(), s) != reserved.end();
+}
+
+// the value of an option whose name() is value
+template <typename T, size_t N>
+static T option(const array<T, N>& values, const string& value) {
+    for (T t : values) {
+        if (name(t) == value) {
+            return t;
+        }
+    }
+    error("Generator Error: unknown option value " + value);
+}
+
+struct Declaration {
+    string name;
+    vector<string> variables;
+    vector<ValueType> types;
+    string expression;
+};
+
+static Declaration parse(const string& line, const string& location) {
+    size_t open = line.find('(');
+    size_t close = line.find(')', open);
+    size_t assign = line.find('=', close);
+    if (open == string::npos || close == string::npos || assign == string::npos ||
+        !trim(line.substr(close + 1, assign - close - 1)).empty()) {
+        error("Generator Error: " + location + ": expected name(variables) = expression");
+    }
+    Declaration declaration{trim(line.substr(0, open)), {}, {}, trim(line.substr(assign + 1))};
+    if (!isIdentifier(declaration.name)) {
+        error("Generator Error: " + location + ": invalid name " + declaration.name);
+    }
+    if (isReserved(declaration.name)) {
+        error("Generator Error: " + location + ": reserved name " + declaration.name);
+    }
+    bool typed = false;
+    istringstream parameters(line.substr(open + 1, close - open - 1));
+    for (string parameter; getline(parameters, parameter, ',');) {
+        size_t colon = parameter.find(':');
+        string variable = trim(parameter.substr(0, colon));
+        string type = colon == string::npos ? "any" : trim(parameter.substr(colon + 1));
+        if (!isIdentifier(variable)) {
+            error("Generator Error: " + location + ": invalid variable " + variable);
+        }
+        if (isReserved(variable)) {
+            error("Generator Error: " + location + ": reserved variable " + variable);
+        }
+        declaration.variables.push_back(variable);
+        if (type == "integer") {
+            declaration.types.push_back(ValueType::integer);
+        } else if (type == "floating") {
+            declaration.types.push_back(ValueType::floating);
+        } else if (type == "any") {
+            declaration.types.push_back(ValueType::any);
+        } else {
+            error("Generator Error: " + location + ": unknown type " + type);
+        }
+        typed |= type != "any";
+    }
+    if (!typed) {
+        declaration.types.clear();
+    }
+    return declaration;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        error("usage: libevaluate_generate <input> <output> [--namespace=ns] [--accuracy=..] "
+              "[--overflow=..] [--fp=..] [--level=..]");
+    }
+    string input = argv[1];
+    string output = argv[2];
+    string ns = "expressions";
+    Options options;
+    for (int i = 3; i < argc; ++i) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        string key = argument.substr(0, equals);
+        string value = equals == string::npos ? "" : argument.substr(equals + 1);
+        if (key == "--namespace") {
+            ns = value;
+        } else if (key == "--accuracy") {
+            options.accuracy =
+                option(array{Accuracy::standard, Accuracy::precise, Accuracy::fast}, value);
+        } else if (key == "--overflow") {
+            options.overflow =
+                option(array{OverflowPolicy::promote, OverflowPolicy::error}, value);
+        } else if (key == "--fp") {
+            options.fp =
+                option(array{FloatPolicy::strict, FloatPolicy::contract, FloatPolicy::fast}, value);
+        } else if (key == "--level") {
+            options.level = option(
+                array{OptimizationLevel::O0, OptimizationLevel::O1, OptimizationLevel::O2}, value);
+        } else {
+            error("Generator Error: unknown option " + argument);
+        }
+    }
+
+    ifstream in(input);
+    if (!in) {
+        error("Generator Error: cannot read " + input);
+    }
+    ostringstream header;
+    header << "// generated by libevaluate_generate from " << input << " with " << options
+           << "\n#pragma once\n\n#include <aot/Runtime.hpp>\n#include <bit>\n#include <cmath>\n"
+           << "#include <cstdint>\n#include <variant>\n\nnamespace " << ns << " {\n";
+    size_t number = 0;
+    for (string line; getline(in, line);) {
+        ++number;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        auto declaration = parse(line, input + ":" + to_string(number));
+        Evaluator evaluator(declaration.expression, declaration.variables, options,
+                            declaration.types);
+        header << "\n// " << declaration.expression << '\n'
+               << CodeGenerator(evaluator).generate(declaration.name);
+    }
+    header << "\n} // namespace " << ns << '\n';
+
+    ofstream out(output);
+    if (!(out << header.str())) {
+        error("Generator Error: cannot write " + output);
+    }
+    return 0;
+}
@@ -0,0 +1,347 @@
+#include "BatchEvaluator.hpp"
+#include "Functions.hpp"
+#include "analyze/AST.hpp"
+#include "math/VectorMath.hpp"
+#include "util/Error.hpp"
+
+#include <cmath>
+#include <utility>
+
+using namespace std;
+
+namespace evaluate {
+
+static vector<double> toDouble(Column column) {
+    if (holds_alternative<vector<double>>(column)) {
+        return std::get<vector<double>>(move(column));
+    } else {
+        auto& values = std::get<vector<int64_t>>(column);
+        return vector<double>(values.begin(), values.end());
+    }
+}
+static size_t size(const Column& column) {
+    return std::visit([](auto& values) { return values.size(); }, column);
+}
+// the number of rows of an operation on a and b, an invariant column has a single row
+static size_t common(const Column& a, const Column& b) { return size(a) == 1 ? size(b) : size(a); }
+// repeats the value of an invariant column for every row
+static void broadcast(Column& column, size_t rows) {
+    if (size(column) == 1 && rows != 1) {
+        std::visit(
+            [&](auto& values) {
+                auto value = values.front();
+                values.assign(rows, value);
+            },
+            column);
+    }
+}
+static variant<int64_t, double> at(const Column& column, size_t row) {
+    if (holds_alternative<vector<double>>(column)) {
+        return std::get<vector<double>>(column)[row];
+    } else {
+        return std::get<vector<int64_t>>(column)[row];
+    }
+}
+
+BatchEvaluator::BatchEvaluator(const Code& code, const Options& options, span<const Column> columns,
+                               size_t rows)
+    : code(code), options(options), columns(columns), rows(rows) {
+    for (auto& column : columns) {
+        if (size(column) != rows && size(column) != 1) {
+            error("Evaluation Error: column size does not match the number of rows");
+        }
+    }
+}
+Column BatchEvaluator::evaluate(const AST& ast) {
+    ast.accept(*this);
+    broadcast(reg, rows);
+    return move(reg);
+}
+
+void BatchEvaluator::visit(const VALUE& node) {
+    if (node.isFP()) {
+        reg = vector<double>{node.asDouble()};
+    } else {
+        reg = vector<int64_t>{node.asInt()};
+    }
+}
+void BatchEvaluator::visit(const VARIABLE& node) {
+    reg = columns[node.getIndex()];
+    // integer columns of floating variables are converted, like single values
+    if (node.getValueType() == ValueType::floating && holds_alternative<vector<int64_t>>(reg)) {
+        reg = toDouble(move(reg));
+    }
+}
+void BatchEvaluator::visit(const FUNCTION& node) {
+    auto type = node.getFunctionType();
+    vector<Column> parameters{};
+    // the function is evaluated once if all parameters are invariant
+    size_t n = 1;
+    for (auto& p : node.getParameters()) {
+        p->accept(*this);
+        n = size(reg) == 1 ? n : size(reg);
+        parameters.emplace_back(move(reg));
+    }
+    for (auto& p : parameters) {
+        broadcast(p, n);
+    }
+    if (isIntegerFunction(type)) {
+        vector<span<const int64_t>> params{};
+        for (auto& p : parameters) {
+            if (holds_alternative<vector<double>>(p)) {
+                error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+                      "Evaluation Error: invalid usage of integer function on floating points");
+            }
+            params.emplace_back(std::get<vector<int64_t>>(p));
+        }
+        vector<int64_t> result(n);
+        simd::call(type, params, result);
+        reg = move(result);
+        return;
+    }
+    if (type == FunctionType::pow && parameters.size() == 2) {
+        power(node, move(parameters[0]), move(parameters[1]), nullptr);
+        return;
+    }
+    if (simd::hasKernel(type, options.accuracy)) {
+        vector<vector<double>> values{};
+        vector<span<const double>> params{};
+        values.reserve(parameters.size());
+        for (auto& p : parameters) {
+            params.emplace_back(values.emplace_back(toDouble(move(p))));
+        }
+        vector<double> result(n);
+        simd::call(type, options.accuracy, params, result);
+        reg = move(result);
+        return;
+    }
+    vector<variant<int64_t, double>> values(parameters.size());
+    vector<variant<int64_t, double>> results{};
+    results.reserve(n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            values[i] = at(parameters[i], row);
+        }
+        results.emplace_back(call(type, values));
+    }
+    if (!results.empty() && holds_alternative<int64_t>(results.front())) {
+        vector<int64_t> result{};
+        result.reserve(n);
+        for (auto& r : results) {
+            result.emplace_back(std::get<int64_t>(r));
+        }
+        reg = move(result);
+    } else {
+        vector<double> result{};
+        result.reserve(n);
+        for (auto& r : results) {
+            result.emplace_back(getAsDouble(r));
+        }
+        reg = move(result);
+    }
+}
+
+template <typename IntOp, typename DoubleOp>
+requires std::invocable<IntOp, int64_t, int64_t> && std::invocable<DoubleOp, double, double>
+void BatchEvaluator::visitArithmetic(const BinaryAST& node, IntOp intOp, DoubleOp doubleOp) {
+    node.getLExpr().accept(*this);
+    Column l = move(reg);
+    node.getRExpr().accept(*this);
+    size_t n = common(l, reg);
+    broadcast(l, n);
+    broadcast(reg, n);
+    if (holds_alternative<vector<double>>(l) || holds_alternative<vector<double>>(reg)) {
+        auto lhs = toDouble(move(l));
+        auto rhs = toDouble(move(reg));
+        for (size_t i = 0; i < n; ++i) {
+            lhs[i] = doubleOp(lhs[i], rhs[i]);
+        }
+        reg = move(lhs);
+    } else {
+        auto& lhs = std::get<vector<int64_t>>(l);
+        auto& rhs = std::get<vector<int64_t>>(reg);
+        for (size_t i = 0; i < n; ++i) {
+            lhs[i] = intOp(lhs[i], rhs[i]);
+        }
+        reg = move(l);
+    }
+}
+template <typename IntOp>
+requires std::invocable<IntOp, int64_t, int64_t>
+void BatchEvaluator::visitBitwise(const BinaryAST& node, IntOp op) {
+    node.getLExpr().accept(*this);
+    Column l = move(reg);
+    node.getRExpr().accept(*this);
+    if (holds_alternative<vector<double>>(l) || holds_alternative<vector<double>>(reg)) {
+        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+              "Evaluation Error: invalid usage of bitwise operator on double");
+    } else {
+        size_t n = common(l, reg);
+        broadcast(l, n);
+        broadcast(reg, n);
+        auto& lhs = std::get<vector<int64_t>>(l);
+        auto& rhs = std::get<vector<int64_t>>(reg);
+        for (size_t i = 0; i < n; ++i) {
+            lhs[i] = op(lhs[i], rhs[i]);
+        }
+        reg = move(l);
+    }
+}
+
+// a column has a single type, so the whole column is promoted if any row has to be
+void BatchEvaluator::power(const AST& node, Column base, Column exponent,
+                           IntegerPower integerPower) {
+    size_t n = common(base, exponent);
+    broadcast(base, n);
+    broadcast(exponent, n);
+    if (holds_alternative<vector<int64_t>>(base) && holds_alternative<vector<int64_t>>(exponent)) {
+        auto& bases = std::get<vector<int64_t>>(base);
+        auto& exponents = std::get<vector<int64_t>>(exponent);
+        vector<int64_t> result(n);
+        bool negative = false, overflow = false;
+        for (size_t i = 0; i < n; ++i) {
+            if (exponents[i] < 0) {
+                negative = true;
+            } else if (integerPower ? !integerPower(bases[i], result[i])
+                                    : !ipow(bases[i], exponents[i], result[i])) {
+                overflow = true;
+            }
+        }
+        if (!negative && !overflow) {
+            reg = move(result);
+            return;
+        } else if (overflow && options.overflow == OverflowPolicy::error) {
+            error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+                  "Evaluation Error: integer overflow in exponentiation");
+        }
+    }
+    auto lhs = toDouble(move(base));
+    auto rhs = toDouble(move(exponent));
+    for (size_t i = 0; i < n; ++i) {
+        lhs[i] = pow(lhs[i], rhs[i]);
+    }
+    reg = move(lhs);
+}
+void BatchEvaluator::visit(const POW& node) {
+    node.getLExpr().accept(*this);
+    Column base = move(reg);
+    node.getRExpr().accept(*this);
+    power(node, move(base), move(reg), node.getIntegerPower());
+}
+void BatchEvaluator::visit(const OR& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l | r; });
+}
+void BatchEvaluator::visit(const XOR& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l ^ r; });
+}
+void BatchEvaluator::visit(const AND& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l & r; });
+}
+void BatchEvaluator::visit(const SHL& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l << r; });
+}
+void BatchEvaluator::visit(const SHR& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l >> r; });
+}
+void BatchEvaluator::visit(const ADD& node) {
+    visitArithmetic(
+        node, [](int64_t l, int64_t r) { return l + r; }, [](double l, double r) { return l + r; });
+}
+void BatchEvaluator::visit(const MINUS& node) {
+    visitArithmetic(
+        node, [](int64_t l, int64_t r) { return l - r; }, [](double l, double r) { return l - r; });
+}
+void BatchEvaluator::visit(const MUL& node) {
+    visitArithmetic(
+        node, [](int64_t l, int64_t r) { return l * r; }, [](double l, double r) { return l * r; });
+}
+// a constant divisor is not expanded into a column
+void BatchEvaluator::visit(const DIV& node) {
+    auto reciprocal = node.getReciprocal();
+    if (!reciprocal) {
+        visitArithmetic(
+            node, [](int64_t l, int64_t r) { return l / r; },
+            [](double l, double r) { return l / r; });
+        return;
+    }
+    auto divisor = static_cast<const VALUE&>(node.getRExpr()).getValue();
+    node.getLExpr().accept(*this);
+    if (holds_alternative<vector<int64_t>>(reg) && holds_alternative<int64_t>(divisor)) {
+        auto& values = std::get<vector<int64_t>>(reg);
+        if (node.getDivisor()) {
+            for (auto& v : values) {
+                v = node.getDivisor()->divide(v);
+            }
+        } else {
+            for (auto& v : values) {
+                v /= std::get<int64_t>(divisor);
+            }
+        }
+    } else {
+        auto values = toDouble(move(reg));
+        if (node.isExactReciprocal() || options.relaxed()) {
+            for (auto& v : values) {
+                v *= *reciprocal;
+            }
+        } else {
+            for (auto& v : values) {
+                v /= getAsDouble(divisor);
+            }
+        }
+        reg = move(values);
+    }
+}
+void BatchEvaluator::visit(const MOD& node) {
+    if (!node.getDivisor()) {
+        visitArithmetic(
+            node, [](int64_t l, int64_t r) { return l % r; },
+            [](double l, double r) { return fmod(l, r); });
+        return;
+    }
+    auto& divisor = *node.getDivisor();
+    node.getLExpr().accept(*this);
+    if (holds_alternative<vector<int64_t>>(reg)) {
+        for (auto& v : std::get<vector<int64_t>>(reg)) {
+            v = divisor.modulo(v);
+        }
+    } else {
+        auto values = toDouble(move(reg));
+        for (auto& v : values) {
+            v = fmod(v, static_cast<double>(divisor.getDivisor()));
+        }
+        reg = move(values);
+    }
+}
+void BatchEvaluator::visit(const UnaryMINUS& node) {
+    node.getChild().accept(*this);
+    std::visit([](auto& values) {
+        for (auto& v : values) {
+            v = -v;
+        }
+    }, reg);
+}
+void BatchEvaluator::visit(const UnaryPLUS& node) { node.getChild().accept(*this); }
+void BatchEvaluator::visit(const UnaryCOMP& node) {
+    node.getChild().accept(*this);
+    if (holds_alternative<vector<double>>(reg)) {
+        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+              "Evaluation Error: invalid usage of bitwise operator on double");
+    } else {
+        for (auto& v : std::get<vector<int64_t>>(reg)) {
+            v = ~v;
+        }
+    }
+}
+void BatchEvaluator::visit(const SHARED& node) {
+    if (shared.size() <= node.getIndex()) {
+        shared.resize(node.getIndex() + 1);
+    }
+    if (shared[node.getIndex()]) {
+        reg = *shared[node.getIndex()];
+    } else {
+        node.getExpression().accept(*this);
+        shared[node.getIndex()] = reg;
+    }
+}
+
+} // namespace evaluate
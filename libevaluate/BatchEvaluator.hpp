@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Options.hpp"
+#include "analyze/ASTVisitor.hpp"
+#include "math/Integer.hpp"
+#include "util/Code.hpp"
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+namespace evaluate {
+class AST;
+class BinaryAST;
+
+using Column = std::variant<std::vector<int64_t>, std::vector<double>>;
+
+// evaluates an AST over columns of variable values, one row at a time for the operators
+// and a whole column at a time for the functions.
+// a column with a single value is the same for every row, and so is every node that only depends
+// on such columns and constants. these invariant nodes are evaluated once per batch and only
+// repeated for every row where they meet a node that differs per row
+class BatchEvaluator : private ASTVisitor {
+    private:
+    const Code& code;
+    const Options& options;
+    std::span<const Column> columns;
+    size_t rows;
+    Column reg;
+    std::vector<std::optional<Column>> shared;
+
+    public:
+    BatchEvaluator(const Code& code, const Options& options, std::span<const Column> columns,
+                   size_t rows);
+    Column evaluate(const AST& ast);
+
+    private:
+    void visit(const VALUE& node) override;
+    void visit(const VARIABLE& node) override;
+    void visit(const FUNCTION& node) override;
+    void visit(const POW& node) override;
+    void visit(const OR& node) override;
+    void visit(const XOR& node) override;
+    void visit(const AND& node) override;
+    void visit(const SHL& node) override;
+    void visit(const SHR& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+    void visit(const MUL& node) override;
+    void visit(const DIV& node) override;
+    void visit(const MOD& node) override;
+    void visit(const UnaryMINUS& node) override;
+    void visit(const UnaryPLUS& node) override;
+    void visit(const UnaryCOMP& node) override;
+    void visit(const SHARED& node) override;
+
+    template <typename IntOp, typename DoubleOp>
+    requires std::invocable<IntOp, int64_t, int64_t> && std::invocable<DoubleOp, double, double>
+    void visitArithmetic(const BinaryAST& node, IntOp intOp, DoubleOp doubleOp);
+
+    template <typename IntOp>
+    requires std::invocable<IntOp, int64_t, int64_t>
+    void visitBitwise(const BinaryAST& node, IntOp op);
+
+    void power(const AST& node, Column base, Column exponent, IntegerPower integerPower);
+};
+
+} // namespace evaluate
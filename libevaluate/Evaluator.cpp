@@ -1,8 +1,22 @@
 #include "Evaluator.hpp"
 #include "Functions.hpp"
 #include "analyze/Analyzer.hpp"
+#include "math/VectorMath.hpp"
+#include "optimize/ConstantFolder.hpp"
+#include "optimize/HornerRewriter.hpp"
+#include "optimize/IdiomRewriter.hpp"
+#include "optimize/PassManager.hpp"
+#include "optimize/Reassociator.hpp"
+#include "optimize/Simplifier.hpp"
+#include "optimize/Specializer.hpp"
+#include "optimize/SubexpressionEliminator.hpp"
 #include "util/Error.hpp"
+#include "vm/Compiler.hpp"
+#include "vm/Tiering.hpp"
+#include "vm/VM.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <utility>
 
@@ -10,158 +24,464 @@ using namespace std;
 
 namespace evaluate {
 
-Evaluator::Evaluator(string expr) : code(move(expr)) {}
-variant<int64_t, double> Evaluator::get() {
-    Analyzer analyzer(code);
-    auto result = analyzer.analyze();
-    result->accept(*this);
-    return value;
+Evaluator::Evaluator(string expr, vector<string> variables, Options options,
+                     vector<ValueType> types)
+    : code(make_shared<const Code>(move(expr))), variables(move(variables)), types(move(types)),
+      options(options) {
+    if (this->types.empty()) {
+        this->types.assign(this->variables.size(), ValueType::any);
+    } else if (this->types.size() != this->variables.size()) {
+        error("Semantic Error: number of types does not match the number of variables");
+    }
+    integers.resize(this->variables.size());
+    floatings.resize(this->variables.size());
+    Analyzer analyzer(*code, this->variables, this->types);
+    ast = analyzer.analyze();
+    PassManager passes(*code, this->options.dump, statistics);
+    optimize(passes);
+}
+Evaluator::Evaluator(const Evaluator& evaluator,
+                     span<const optional<variant<int64_t, double>>> values, const Options& options)
+    : code(evaluator.code), options(options), rewrites(evaluator.rewrites) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!values[i]) {
+            variables.push_back(evaluator.variables[i]);
+            types.push_back(evaluator.types[i]);
+        }
+    }
+    integers.resize(variables.size());
+    floatings.resize(variables.size());
+    ast = clone(*evaluator.ast);
+    PassManager passes(*code, options.dump, statistics);
+    if (ranges::any_of(values, [](auto& value) { return value.has_value(); })) {
+        passes.add("specialize", [values](const AST& ast) {
+            Specializer specializer(values);
+            return specializer.specialize(ast);
+        });
+    }
+    optimize(passes);
+}
+void Evaluator::optimize(PassManager& passes) {
+    if (options.backend == Backend::tiered) {
+        // the first tier is not optimized, Tiering compiles the expression once it is hot
+        ast = passes.run(move(ast));
+        tiering = make_unique<Tiering>(options.threshold);
+        return;
+    }
+    if (options.level != OptimizationLevel::O0) {
+        passes.add("fold", [this](const AST& ast) {
+            ConstantFolder folder([this](const AST& node) { return evaluate(node).get(); });
+            return folder.fold(ast);
+        });
+        passes.add("simplify", [this](const AST& ast) {
+            Simplifier simplifier(options, rewrites);
+            return simplifier.simplify(ast);
+        });
+    }
+    if (options.level == OptimizationLevel::O2) {
+        if (options.relaxed()) {
+            passes.add("horner", [this](const AST& ast) {
+                HornerRewriter horner(rewrites);
+                return horner.rewrite(ast);
+            });
+        }
+        passes.add("reassociate", [this](const AST& ast) {
+            Reassociator reassociator(options, rewrites);
+            return reassociator.reassociate(ast);
+        });
+        if (options.contracts()) {
+            passes.add("idioms", [this](const AST& ast) {
+                IdiomRewriter rewriter(options, rewrites);
+                return rewriter.rewrite(ast);
+            });
+        }
+    }
+    if (options.level != OptimizationLevel::O0) {
+        passes.add("cse", [this](const AST& ast) {
+            SubexpressionEliminator eliminator(sharing);
+            return eliminator.eliminate(ast);
+        });
+    }
+    ast = passes.run(move(ast));
+    shared.resize(sharing.expressions);
+    evaluated.resize(sharing.expressions);
+    if (options.backend != Backend::tree) {
+        Compiler compiler(options, types, sharing.expressions);
+        bool retained = options.retain == Retain::source;
+        vm = make_unique<VM>(retained ? code : nullptr, options, compiler.compile(*ast));
+        if (!retained) {
+            // the rewrites keep the offsets of the code they rewrote, but not the dropped source
+            vector<Rewrite> detached;
+            for (auto& rewrite : rewrites) {
+                CodeReference codeRef(rewrite.codeRef.getFrom(), rewrite.codeRef.getTo(), {});
+                detached.push_back({rewrite.name, codeRef, rewrite.policy});
+            }
+            rewrites = move(detached);
+            ast.reset();
+            code.reset();
+        }
+    }
 }
+Evaluator::~Evaluator() noexcept = default;
+Evaluator::Evaluator(Evaluator&&) noexcept = default;
+Evaluator& Evaluator::operator=(Evaluator&&) noexcept = default;
 
-void Evaluator::visit(const evaluate::VALUE& node) { value = node.getValue(); }
-void Evaluator::visit(const evaluate::FUNCTION& node) {
-    auto type = node.getFunctionType();
-    auto& parameters = node.getParameters();
-    vector<variant<int64_t, double>> values{};
-    for (auto& p : parameters) {
-        p->accept(*this);
-        values.emplace_back(value);
+variant<int64_t, double> Evaluator::get() { return get({}); }
+variant<int64_t, double> Evaluator::get(span<const variant<int64_t, double>> values) {
+    if (values.size() != variables.size()) {
+        error("Evaluation Error: number of values does not match the number of variables");
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (types[i] == ValueType::integer && holds_alternative<double>(values[i])) {
+            error("Evaluation Error: double value for integer variable " + variables[i]);
+        }
+    }
+    if (vm) {
+        return vm->run(values);
     }
-    // TODO: optimize this
-    value = call(type, values);
+    if (tiering) {
+        if (Evaluator* promoted = tiering->count(*this, 1)) {
+            return promoted->vm->run(values);
+        }
+    }
+    this->values = values;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (types[i] == ValueType::integer) {
+            integers[i] = std::get<int64_t>(values[i]);
+        } else if (types[i] == ValueType::floating) {
+            floatings[i] = getAsDouble(values[i]);
+        }
+    }
+    ranges::fill(evaluated, 0);
+    return evaluate(*ast).get();
 }
-void Evaluator::visit(const evaluate::POW& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        value = pow(getAsDouble(v), getAsDouble(value));
+Column Evaluator::get(span<const Column> columns, size_t rows) {
+    if (columns.size() != variables.size()) {
+        error("Evaluation Error: number of columns does not match the number of variables");
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (types[i] == ValueType::integer && holds_alternative<vector<double>>(columns[i])) {
+            error("Evaluation Error: double column for integer variable " + variables[i]);
+        }
+    }
+    if (tiering) {
+        if (Evaluator* promoted = tiering->count(*this, rows)) {
+            return promoted->get(columns, rows);
+        }
+    }
+    if (!ast) {
+        error("Evaluation Error: columns need the AST, which Retain::" +
+              string(name(options.retain)) + " does not keep");
+    }
+    BatchEvaluator evaluator(*code, options, columns, rows);
+    return evaluator.evaluate(*ast);
+}
+Evaluator Evaluator::specialize(const vector<Binding>& bindings) const {
+    if (!ast) {
+        error("Semantic Error: specializing needs the AST, which Retain::" +
+              string(name(options.retain)) + " does not keep");
+    }
+    vector<optional<variant<int64_t, double>>> values(variables.size());
+    for (auto& [name, value] : bindings) {
+        auto i = static_cast<size_t>(ranges::find(variables, name) - variables.begin());
+        if (i == variables.size()) {
+            error("Semantic Error: unknown variable " + name);
+        }
+        if (types[i] == ValueType::integer && holds_alternative<double>(value)) {
+            error("Evaluation Error: double value for integer variable " + name);
+        }
+        values[i] = types[i] == ValueType::floating ? getAsDouble(value) : value;
+    }
+    return Evaluator(*this, values, options);
+}
+const vector<string>& Evaluator::getVariables() const { return variables; }
+const vector<ValueType>& Evaluator::getTypes() const { return types; }
+const Options& Evaluator::getOptions() const { return options; }
+Backend Evaluator::getBackend() const {
+    if (tiering) {
+        auto* promoted = tiering->getPromoted();
+        return promoted ? promoted->getBackend() : Backend::tree;
+    }
+    if (!vm) {
+        return Backend::tree;
+    }
+    return vm->isCompiled() ? Backend::jit : Backend::bytecode;
+}
+TierStatistics Evaluator::getTierStatistics() const {
+    return tiering ? tiering->getStatistics() : TierStatistics{};
+}
+const vector<Rewrite>& Evaluator::getRewrites() const { return rewrites; }
+const AST& Evaluator::getAST() const {
+    if (!ast) {
+        error("Semantic Error: Retain::" + string(name(options.retain)) + " does not keep the AST");
+    }
+    return *ast;
+}
+const vector<Location>& Evaluator::getLocations() const {
+    static const vector<Location> none;
+    return vm ? vm->getProgram().locations : none;
+}
+const SharingStatistics& Evaluator::getSharingStatistics() const { return sharing; }
+const vector<PassStatistics>& Evaluator::getPassStatistics() const { return statistics; }
+
+Value Evaluator::evaluate(const AST& node) {
+    node.accept(*this);
+    switch (node.getValueType()) {
+        case ValueType::integer: return Value(integer);
+        case ValueType::floating: return Value(floating);
+        default: return fp ? Value(floating) : Value(integer);
+    }
+}
+int64_t Evaluator::integerOf(const AST& node) {
+    node.accept(*this);
+    return integer;
+}
+double Evaluator::floatingOf(const AST& node) {
+    node.accept(*this);
+    switch (node.getValueType()) {
+        case ValueType::integer: return static_cast<double>(integer);
+        case ValueType::floating: return floating;
+        default: return fp ? floating : static_cast<double>(integer);
+    }
+}
+void Evaluator::store(Value result) {
+    if (result.fp) {
+        floating = result.f;
     } else {
-        value = pow(std::get<int64_t>(v), std::get<int64_t>(value));
+        integer = result.i;
     }
+    fp = result.fp;
 }
-void Evaluator::visit(const evaluate::OR& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
-              "Evaluation Error: invalid usage of bitwise operator on double");
+
+void Evaluator::visit(const evaluate::VALUE& node) {
+    if (node.isFP()) {
+        floating = node.asDouble();
     } else {
-        value = std::get<int64_t>(v) | std::get<int64_t>(value);
+        integer = node.asInt();
     }
 }
-void Evaluator::visit(const evaluate::XOR& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
-              "Evaluation Error: invalid usage of bitwise operator on double");
+void Evaluator::visit(const evaluate::VARIABLE& node) {
+    switch (node.getValueType()) {
+        case ValueType::integer: integer = integers[node.getIndex()]; break;
+        case ValueType::floating: floating = floatings[node.getIndex()]; break;
+        default: store(Value(values[node.getIndex()]));
+    }
+}
+void Evaluator::visit(const evaluate::FUNCTION& node) {
+    auto type = node.getFunctionType();
+    auto& parameters = node.getParameters();
+    if (node.getValueType() == ValueType::floating && simd::hasKernel(type, options.accuracy) &&
+        parameters.size() <= 3) {
+        array<double, 3> doubles{};
+        array<span<const double>, 3> params{};
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            doubles[i] = floatingOf(*parameters[i]);
+            params[i] = span(&doubles[i], 1);
+        }
+        simd::call(type, options.accuracy, params, span(&floating, 1));
+        return;
+    }
+    // no function has more than three parameters, so they fit on the stack and more are not
+    // evaluated, like the bytecode does
+    // the functions of Functions.hpp take the variant
+    array<variant<int64_t, double>, 3> arguments{};
+    span<variant<int64_t, double>> values(arguments.data(),
+                                          min(parameters.size(), arguments.size()));
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = evaluate(*parameters[i]).get();
+    }
+    if (type == FunctionType::pow && values.size() == 2 && holds_alternative<int64_t>(values[0]) &&
+        holds_alternative<int64_t>(values[1])) {
+        store(power(node, std::get<int64_t>(values[0]), std::get<int64_t>(values[1]), nullptr));
+    } else if (simd::hasKernel(type, options.accuracy)) {
+        array<double, 3> doubles{};
+        array<span<const double>, 3> params{};
+        for (size_t i = 0; i < values.size() && i < doubles.size(); ++i) {
+            doubles[i] = getAsDouble(values[i]);
+            params[i] = span(&doubles[i], 1);
+        }
+        double result;
+        simd::call(type, options.accuracy, params, span(&result, 1));
+        store(Value(result));
     } else {
-        value = std::get<int64_t>(v) ^ std::get<int64_t>(value);
+        store(Value(call(type, values)));
     }
 }
-void Evaluator::visit(const evaluate::AND& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
-              "Evaluation Error: invalid usage of bitwise operator on double");
+void Evaluator::visit(const evaluate::POW& node) {
+    if (node.getValueType() == ValueType::floating) {
+        double base = floatingOf(node.getLExpr());
+        floating = pow(base, floatingOf(node.getRExpr()));
+        return;
+    }
+    auto v = evaluate(node.getLExpr());
+    auto exponent = evaluate(node.getRExpr());
+    if (quicken(node, v, exponent) == Quickening::doubles) {
+        store(Value(pow(v.f, exponent.f)));
+    } else if (v.fp || exponent.fp) {
+        store(Value(pow(v.asDouble(), exponent.asDouble())));
     } else {
-        value = std::get<int64_t>(v) & std::get<int64_t>(value);
+        store(power(node, v.i, exponent.i, node.getIntegerPower()));
     }
 }
-void Evaluator::visit(const evaluate::SHL& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
-              "Evaluation Error: invalid usage of bitwise operator on double");
+Value Evaluator::power(const AST& node, int64_t base, int64_t exponent,
+                       IntegerPower integerPower) const {
+    int64_t result;
+    if (exponent < 0) {
+        return Value(pow(base, exponent));
+    } else if (integerPower ? integerPower(base, result) : ipow(base, exponent, result)) {
+        return Value(result);
+    } else if (options.overflow == OverflowPolicy::error) {
+        error(node.getCodeRef().getFrom(), node.getCode().size(), *code,
+              "Evaluation Error: integer overflow in exponentiation");
     } else {
-        value = std::get<int64_t>(v) << std::get<int64_t>(value);
+        return Value(pow(base, exponent));
     }
 }
-void Evaluator::visit(const evaluate::SHR& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+
+template <typename IntOp, typename DoubleOp>
+void Evaluator::visitArithmetic(const BinaryAST& node, IntOp intOp, DoubleOp doubleOp) {
+    switch (node.getValueType()) {
+        case ValueType::integer: {
+            int64_t l = integerOf(node.getLExpr());
+            integer = intOp(l, integerOf(node.getRExpr()));
+            break;
+        }
+        case ValueType::floating: {
+            double l = floatingOf(node.getLExpr());
+            floating = doubleOp(l, floatingOf(node.getRExpr()));
+            break;
+        }
+        default: {
+            auto l = evaluate(node.getLExpr());
+            auto r = evaluate(node.getRExpr());
+            switch (quicken(node, l, r)) {
+                case Quickening::integers: store(Value(intOp(l.i, r.i))); break;
+                case Quickening::integerDouble:
+                    store(Value(doubleOp(static_cast<double>(l.i), r.f)));
+                    break;
+                case Quickening::doubleInteger:
+                    store(Value(doubleOp(l.f, static_cast<double>(r.i))));
+                    break;
+                case Quickening::doubles: store(Value(doubleOp(l.f, r.f))); break;
+                default:
+                    if (l.fp || r.fp) {
+                        store(Value(doubleOp(l.asDouble(), r.asDouble())));
+                    } else {
+                        store(Value(intOp(l.i, r.i)));
+                    }
+            }
+        }
+    }
+}
+// the guard of a quickened node, the specialization the operands l and r can be evaluated with
+Quickening Evaluator::quicken(const BinaryAST& node, Value l, Value r) {
+    auto seen = static_cast<Quickening>(l.fp << 1 | r.fp);
+    auto quickening = node.getQuickening();
+    if (seen == quickening || quickening == Quickening::generic) {
+        return quickening;
+    }
+    quickening = quickening == Quickening::none ? seen : Quickening::generic;
+    node.quicken(quickening);
+    return quickening;
+}
+template <typename IntOp> void Evaluator::visitBitwise(const BinaryAST& node, IntOp op) {
+    auto& l_expr = node.getLExpr();
+    auto& r_expr = node.getRExpr();
+    if (l_expr.getValueType() == ValueType::integer &&
+        r_expr.getValueType() == ValueType::integer) {
+        int64_t l = integerOf(l_expr);
+        integer = op(l, integerOf(r_expr));
+        return;
+    }
+    auto l = evaluate(l_expr);
+    auto r = evaluate(r_expr);
+    if (l.fp || r.fp) {
+        error(node.getCodeRef().getFrom(), node.getCode().size(), *code,
               "Evaluation Error: invalid usage of bitwise operator on double");
-    } else {
-        value = std::get<int64_t>(v) >> std::get<int64_t>(value);
     }
+    integer = op(l.i, r.i);
 }
 
+void Evaluator::visit(const evaluate::OR& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l | r; });
+}
+void Evaluator::visit(const evaluate::XOR& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l ^ r; });
+}
+void Evaluator::visit(const evaluate::AND& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l & r; });
+}
+void Evaluator::visit(const evaluate::SHL& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l << r; });
+}
+void Evaluator::visit(const evaluate::SHR& node) {
+    visitBitwise(node, [](int64_t l, int64_t r) { return l >> r; });
+}
 void Evaluator::visit(const evaluate::ADD& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        value = getAsDouble(v) + getAsDouble(value);
-    } else {
-        value = std::get<int64_t>(v) + std::get<int64_t>(value);
-    }
+    visitArithmetic(
+        node, [](int64_t l, int64_t r) { return l + r; }, [](double l, double r) { return l + r; });
 }
 void Evaluator::visit(const evaluate::MINUS& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        value = getAsDouble(v) - getAsDouble(value);
-    } else {
-        value = std::get<int64_t>(v) - std::get<int64_t>(value);
-    }
+    visitArithmetic(
+        node, [](int64_t l, int64_t r) { return l - r; }, [](double l, double r) { return l - r; });
 }
 void Evaluator::visit(const evaluate::MUL& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        value = getAsDouble(v) * getAsDouble(value);
-    } else {
-        value = std::get<int64_t>(v) * std::get<int64_t>(value);
-    }
+    visitArithmetic(
+        node, [](int64_t l, int64_t r) { return l * r; }, [](double l, double r) { return l * r; });
 }
 void Evaluator::visit(const evaluate::DIV& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        value = getAsDouble(v) / getAsDouble(value);
-    } else {
-        value = std::get<int64_t>(v) / std::get<int64_t>(value);
-    }
+    auto& divisor = node.getDivisor();
+    auto reciprocal = node.getReciprocal();
+    bool multiply = reciprocal && (node.isExactReciprocal() || options.relaxed());
+    visitArithmetic(
+        node,
+        [&](int64_t l, int64_t r) { return divisor ? divisor->divide(l) : l / r; },
+        [&](double l, double r) { return multiply ? l * *reciprocal : l / r; });
 }
 void Evaluator::visit(const evaluate::MOD& node) {
-    node.getLExpr().accept(*this);
-    auto v = value;
-    node.getRExpr().accept(*this);
-    if (holds_alternative<double>(v) || holds_alternative<double>(value)) {
-        value = fmod(getAsDouble(v), getAsDouble(value));
-    } else {
-        value = std::get<int64_t>(v) % std::get<int64_t>(value);
-    }
+    auto& divisor = node.getDivisor();
+    visitArithmetic(
+        node, [&](int64_t l, int64_t r) { return divisor ? divisor->modulo(l) : l % r; },
+        [](double l, double r) { return fmod(l, r); });
 }
 void Evaluator::visit(const evaluate::UnaryMINUS& node) {
-    node.getChild().accept(*this);
-    if (holds_alternative<double>(value)) {
-        value = -getAsDouble(value);
-    } else {
-        value = -std::get<int64_t>(value);
+    switch (node.getValueType()) {
+        case ValueType::integer: integer = -integerOf(node.getChild()); break;
+        case ValueType::floating: floating = -floatingOf(node.getChild()); break;
+        default: {
+            auto v = evaluate(node.getChild());
+            store(v.fp ? Value(-v.f) : Value(-v.i));
+        }
     }
 }
+// the child has the same type, so its result is already in the right register
 void Evaluator::visit(const evaluate::UnaryPLUS& node) { node.getChild().accept(*this); }
 void Evaluator::visit(const evaluate::UnaryCOMP& node) {
-    node.getChild().accept(*this);
-    if (holds_alternative<double>(value)) {
-        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+    if (node.getChild().getValueType() == ValueType::integer) {
+        integer = ~integerOf(node.getChild());
+        return;
+    }
+    auto v = evaluate(node.getChild());
+    if (v.fp) {
+        error(node.getCodeRef().getFrom(), node.getCode().size(), *code,
               "Evaluation Error: invalid usage of bitwise operator on double");
+    }
+    integer = ~v.i;
+}
+void Evaluator::visit(const evaluate::SHARED& node) {
+    size_t i = node.getIndex();
+    if (evaluated[i]) {
+        bool isDouble = evaluated[i] == 2;
+        store(isDouble ? Value(shared[i].f) : Value(shared[i].i));
     } else {
-        value = ~std::get<int64_t>(value);
+        auto result = evaluate(node.getExpression());
+        if (result.fp) {
+            shared[i].f = result.f;
+        } else {
+            shared[i].i = result.i;
+        }
+        evaluated[i] = result.fp ? 2 : 1;
+        store(result);
     }
 }
 
@@ -1,14 +1,30 @@
 #pragma once
 
+#include "BatchEvaluator.hpp"
+#include "Options.hpp"
+#include "ValueType.hpp"
 #include "analyze/ASTVisitor.hpp"
+#include "math/Integer.hpp"
+#include "optimize/Rewrite.hpp"
+#include "optimize/Statistics.hpp"
 #include "util/Code.hpp"
+#include "vm/Bytecode.hpp"
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace evaluate {
+class AST;
+class BinaryAST;
+enum class Quickening : uint8_t;
 class VALUE;
+class VARIABLE;
 class FUNCTION;
 class POW;
 class OR;
@@ -24,18 +40,87 @@ class MOD;
 class UnaryMINUS;
 class UnaryPLUS;
 class UnaryCOMP;
+class SHARED;
+class PassManager;
+class VM;
+class Tiering;
+
+// the value of a variable by its name
+using Binding = std::pair<std::string, std::variant<int64_t, double>>;
 
 class Evaluator : private ASTVisitor {
     private:
-    Code code;
-    std::variant<int64_t, double> value;
+    std::shared_ptr<const Code> code; // shared with the specializations, nullptr if not retained
+    std::vector<std::string> variables;
+    std::vector<ValueType> types;
+    Options options;
+    std::unique_ptr<AST> ast; // nullptr if not retained
+    std::vector<Rewrite> rewrites;
+    SharingStatistics sharing;
+    std::vector<PassStatistics> statistics;
+    std::vector<Register> shared; // the values of the shared expressions
+    // per shared expression, 0 until it is evaluated, then 1 for an integer and 2 for a double
+    std::vector<uint8_t> evaluated;
+    std::unique_ptr<VM> vm; // the compiled expression for Backend::bytecode
+    std::unique_ptr<Tiering> tiering; // the evaluations and the compiled tier of Backend::tiered
+    std::span<const std::variant<int64_t, double>> values;
+    std::vector<int64_t> integers; // values of the integer variables
+    std::vector<double> floatings; // values of the floating variables
+    // the result of a node is in the register of its type,
+    // so nodes with a known type are evaluated without checking the type of their operands.
+    // fp tells which register holds the result of a node without a known type
+    int64_t integer = 0;
+    double floating = 0;
+    bool fp = false;
 
     public:
-    explicit Evaluator(std::string expr);
+    // types declares the type of every variable, all variables can have any type if it is empty
+    explicit Evaluator(std::string expr, std::vector<std::string> variables = {},
+                       Options options = {}, std::vector<ValueType> types = {});
+    ~Evaluator() noexcept;
+    Evaluator(Evaluator&&) noexcept;
+    Evaluator& operator=(Evaluator&&) noexcept;
+
     std::variant<int64_t, double> get();
+    std::variant<int64_t, double> get(std::span<const std::variant<int64_t, double>> values);
+    // evaluates every row of the variable columns, columns are ordered like the variables.
+    // a column with a single value is used for every row, and what only depends on it is
+    // evaluated once. only with Retain::source for bytecode and jit
+    Column get(std::span<const Column> columns, size_t rows);
+    // the expression with the bound variables replaced by their values and optimized again,
+    // the remaining variables keep their order. only with Retain::source for bytecode and jit
+    Evaluator specialize(const std::vector<Binding>& bindings) const;
+    const std::vector<std::string>& getVariables() const;
+    const std::vector<ValueType>& getTypes() const;
+    const Options& getOptions() const;
+    // the backend that evaluates the expression, which is bytecode for Backend::jit where there is
+    // no JIT. Backend::tiered evaluates with tree until the compiled tier is published
+    Backend getBackend() const;
+    // the evaluations and the promotion of Backend::tiered, can be read from any thread
+    TierStatistics getTierStatistics() const;
+    // the rewrites the optimizations did on the expression. without Retain::source for bytecode
+    // and jit, their code references only keep the offsets and str() is empty
+    const std::vector<Rewrite>& getRewrites() const;
+    // only with Retain::source or the tree and tiered backends
+    const AST& getAST() const;
+    // the offset and length in the source of every site of the compiled expression, which
+    // evaluation errors with Retain::none report instead, empty for tree and tiered
+    const std::vector<Location>& getLocations() const;
+    const SharingStatistics& getSharingStatistics() const;
+    // the passes that optimized the expression in the order they ran
+    const std::vector<PassStatistics>& getPassStatistics() const;
 
     private:
+    friend class Tiering;
+    // the specialization of evaluator compiled with options, values has a value for every bound
+    // variable
+    Evaluator(const Evaluator& evaluator,
+              std::span<const std::optional<std::variant<int64_t, double>>> values,
+              const Options& options);
+    void optimize(PassManager& passes);
+
     void visit(const VALUE& node) override;
+    void visit(const VARIABLE& node) override;
     void visit(const FUNCTION& node) override;
     void visit(const POW& node) override;
     void visit(const OR& node) override;
@@ -51,6 +136,18 @@ class Evaluator : private ASTVisitor {
     void visit(const UnaryMINUS& node) override;
     void visit(const UnaryPLUS& node) override;
     void visit(const UnaryCOMP& node) override;
+    void visit(const SHARED& node) override;
+
+    Value evaluate(const AST& node);
+    int64_t integerOf(const AST& node);
+    double floatingOf(const AST& node);
+    void store(Value result);
+
+    Quickening quicken(const BinaryAST& node, Value l, Value r);
+    template <typename IntOp, typename DoubleOp>
+    void visitArithmetic(const BinaryAST& node, IntOp intOp, DoubleOp doubleOp);
+    template <typename IntOp> void visitBitwise(const BinaryAST& node, IntOp op);
+    Value power(const AST& node, int64_t base, int64_t exponent, IntegerPower integerPower) const;
 };
 
 } // namespace evaluate
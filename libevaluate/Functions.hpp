@@ -1,17 +1,34 @@
 #pragma once
 
+#include "math/Integer.hpp"
 #include "util/Error.hpp"
+#include <array>
 #include <cmath>
 #include <concepts>
 #include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <type_traits>
+#include <utility>
+
+// gcc evaluates most functions of <cmath> with constant arguments in a constant evaluation, so the
+// functions below that call them are constexpr there. the special functions and those that depend
+// on the rounding mode or global state, like rint or lgamma, are not. with other compilers only
+// the functions that do not call <cmath> are constexpr
+#if defined(__GNUC__) && !defined(__clang__)
+#define EVALUATE_CMATH_CONSTEXPR constexpr
+#else
+#define EVALUATE_CMATH_CONSTEXPR inline
+#endif
 
 namespace evaluate {
 
-static inline double getAsDouble(std::variant<int64_t, double> value) {
+constexpr double getAsDouble(std::variant<int64_t, double> value) {
     if (holds_alternative<double>(value)) {
         return std::get<double>(value);
     } else {
@@ -88,8 +105,83 @@ enum class FunctionType {
     riemann_zeta,
     sph_bessel,
     sph_legendre,
-    sph_neumann
+    sph_neumann,
+    popcount,
+    clz,
+    ctz,
+    rotl,
+    rotr,
+    bswap,
+    bextract,
+    gcd,
+    modpow
 };
+
+// functions that are only defined on integers
+constexpr bool isIntegerFunction(FunctionType type) {
+    switch (type) {
+        case FunctionType::popcount:
+        case FunctionType::clz:
+        case FunctionType::ctz:
+        case FunctionType::rotl:
+        case FunctionType::rotr:
+        case FunctionType::bswap:
+        case FunctionType::bextract:
+        case FunctionType::gcd:
+        case FunctionType::modpow: return true;
+        default: return false;
+    }
+}
+// functions that pass double parameters unchanged to the <cmath> function of the same name,
+// abs to std::fabs
+constexpr bool isCmathFunction(FunctionType type) {
+    switch (type) {
+        case FunctionType::abs:
+        case FunctionType::fmod:
+        case FunctionType::remainder:
+        case FunctionType::fmax:
+        case FunctionType::fmin:
+        case FunctionType::fdim:
+        case FunctionType::exp:
+        case FunctionType::exp2:
+        case FunctionType::expm1:
+        case FunctionType::log:
+        case FunctionType::log10:
+        case FunctionType::log2:
+        case FunctionType::log1p:
+        case FunctionType::pow:
+        case FunctionType::sqrt:
+        case FunctionType::cbrt:
+        case FunctionType::hypot:
+        case FunctionType::sin:
+        case FunctionType::cos:
+        case FunctionType::tan:
+        case FunctionType::asin:
+        case FunctionType::acos:
+        case FunctionType::atan:
+        case FunctionType::atan2:
+        case FunctionType::sinh:
+        case FunctionType::cosh:
+        case FunctionType::tanh:
+        case FunctionType::asinh:
+        case FunctionType::acosh:
+        case FunctionType::atanh:
+        case FunctionType::erf:
+        case FunctionType::erfc:
+        case FunctionType::tgamma:
+        case FunctionType::lgamma:
+        case FunctionType::ceil:
+        case FunctionType::floor:
+        case FunctionType::trunc:
+        case FunctionType::round:
+        case FunctionType::nearbyint:
+        case FunctionType::rint:
+        case FunctionType::logb:
+        case FunctionType::nextafter:
+        case FunctionType::copysign: return true;
+        default: return false;
+    }
+}
 template <FunctionType> static constexpr inline int functionParams();
 template <> constexpr inline int functionParams<FunctionType::abs>() { return 1; }
 template <> constexpr inline int functionParams<FunctionType::div>() { return 2; }
@@ -160,6 +252,15 @@ template <> constexpr inline int functionParams<FunctionType::riemann_zeta>() {
 template <> constexpr inline int functionParams<FunctionType::sph_bessel>() { return 2; }
 template <> constexpr inline int functionParams<FunctionType::sph_legendre>() { return 3; }
 template <> constexpr inline int functionParams<FunctionType::sph_neumann>() { return 2; }
+template <> constexpr inline int functionParams<FunctionType::popcount>() { return 1; }
+template <> constexpr inline int functionParams<FunctionType::clz>() { return 1; }
+template <> constexpr inline int functionParams<FunctionType::ctz>() { return 1; }
+template <> constexpr inline int functionParams<FunctionType::rotl>() { return 2; }
+template <> constexpr inline int functionParams<FunctionType::rotr>() { return 2; }
+template <> constexpr inline int functionParams<FunctionType::bswap>() { return 1; }
+template <> constexpr inline int functionParams<FunctionType::bextract>() { return 3; }
+template <> constexpr inline int functionParams<FunctionType::gcd>() { return 2; }
+template <> constexpr inline int functionParams<FunctionType::modpow>() { return 3; }
 
 template <FunctionType type>
 requires(functionParams<type>() == 1) static inline std::variant<int64_t, double> functionCall(
@@ -176,27 +277,28 @@ requires(functionParams<type>() == 3) static inline std::variant<int64_t, double
     std::variant<int64_t, double>& param3);
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::abs>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::fabs(std::get<double>(param));
     } else {
-        return std::abs(std::get<int64_t>(param));
+        int64_t value = std::get<int64_t>(param);
+        return value < 0 ? -value : value;
     }
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::div>(std::variant<int64_t, double>& param1,
                                 std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
         error("Evaluation Error: invalid usage of div on floating points");
     }
-    return std::div(std::get<int64_t>(param1), std::get<int64_t>(param2)).quot;
+    return std::get<int64_t>(param1) / std::get<int64_t>(param2);
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::fmod>(std::variant<int64_t, double>& param1,
                                  std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<int64_t>(param1) || std::holds_alternative<int64_t>(param2)) {
@@ -206,7 +308,7 @@ functionCall<FunctionType::fmod>(std::variant<int64_t, double>& param1,
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::remainder>(std::variant<int64_t, double>& param1,
                                       std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -216,7 +318,7 @@ functionCall<FunctionType::remainder>(std::variant<int64_t, double>& param1,
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::fma>(std::variant<int64_t, double>& param1,
                                 std::variant<int64_t, double>& param2,
                                 std::variant<int64_t, double>& param3) {
@@ -230,7 +332,7 @@ functionCall<FunctionType::fma>(std::variant<int64_t, double>& param1,
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::fmax>(std::variant<int64_t, double>& param1,
                                  std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -240,7 +342,7 @@ functionCall<FunctionType::fmax>(std::variant<int64_t, double>& param1,
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::fmin>(std::variant<int64_t, double>& param1,
                                  std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -250,7 +352,7 @@ functionCall<FunctionType::fmin>(std::variant<int64_t, double>& param1,
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::fdim>(std::variant<int64_t, double>& param1,
                                  std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -259,7 +361,7 @@ functionCall<FunctionType::fdim>(std::variant<int64_t, double>& param1,
     return std::fdim(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::exp>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::exp(std::get<double>(param));
@@ -268,7 +370,7 @@ functionCall<FunctionType::exp>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::exp2>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::exp2(std::get<double>(param));
@@ -277,7 +379,7 @@ functionCall<FunctionType::exp2>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::expm1>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::expm1(std::get<double>(param));
@@ -286,7 +388,7 @@ functionCall<FunctionType::expm1>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::log>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::log(std::get<double>(param));
@@ -295,7 +397,7 @@ functionCall<FunctionType::log>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::log10>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::log10(std::get<double>(param));
@@ -304,7 +406,7 @@ functionCall<FunctionType::log10>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::log2>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::log2(std::get<double>(param));
@@ -313,7 +415,7 @@ functionCall<FunctionType::log2>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::log1p>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::log1p(std::get<double>(param));
@@ -323,16 +425,21 @@ functionCall<FunctionType::log1p>(std::variant<int64_t, double>& param) {
 }
 
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::pow>(std::variant<int64_t, double>& param1,
                                 std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
         return std::pow(getAsDouble(param1), getAsDouble(param2));
     }
+    int64_t result;
+    if (std::get<int64_t>(param2) >= 0 &&
+        ipow(std::get<int64_t>(param1), std::get<int64_t>(param2), result)) {
+        return result;
+    }
     return std::pow(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::sqrt>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::sqrt(std::get<double>(param));
@@ -341,7 +448,7 @@ functionCall<FunctionType::sqrt>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::cbrt>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::cbrt(std::get<double>(param));
@@ -350,7 +457,7 @@ functionCall<FunctionType::cbrt>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::hypot>(std::variant<int64_t, double>& param1,
                                   std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -359,7 +466,7 @@ functionCall<FunctionType::hypot>(std::variant<int64_t, double>& param1,
     return std::hypot(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::sin>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::sin(std::get<double>(param));
@@ -368,7 +475,7 @@ functionCall<FunctionType::sin>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::cos>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::cos(std::get<double>(param));
@@ -377,7 +484,7 @@ functionCall<FunctionType::cos>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::tan>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::tan(std::get<double>(param));
@@ -386,7 +493,7 @@ functionCall<FunctionType::tan>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::asin>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::asin(std::get<double>(param));
@@ -395,7 +502,7 @@ functionCall<FunctionType::asin>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::acos>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::acos(std::get<double>(param));
@@ -404,7 +511,7 @@ functionCall<FunctionType::acos>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::atan>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::atan(std::get<double>(param));
@@ -413,7 +520,7 @@ functionCall<FunctionType::atan>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::atan2>(std::variant<int64_t, double>& param1,
                                   std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -422,7 +529,7 @@ functionCall<FunctionType::atan2>(std::variant<int64_t, double>& param1,
     return std::atan2(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::sinh>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::sinh(std::get<double>(param));
@@ -431,7 +538,7 @@ functionCall<FunctionType::sinh>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::cosh>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::cosh(std::get<double>(param));
@@ -440,7 +547,7 @@ functionCall<FunctionType::cosh>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::tanh>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::tanh(std::get<double>(param));
@@ -449,7 +556,7 @@ functionCall<FunctionType::tanh>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::asinh>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::asinh(std::get<double>(param));
@@ -458,7 +565,7 @@ functionCall<FunctionType::asinh>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::acosh>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::acosh(std::get<double>(param));
@@ -467,7 +574,7 @@ functionCall<FunctionType::acosh>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::atanh>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::atanh(std::get<double>(param));
@@ -476,7 +583,7 @@ functionCall<FunctionType::atanh>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::erf>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::erf(std::get<double>(param));
@@ -485,7 +592,7 @@ functionCall<FunctionType::erf>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::erfc>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::erfc(std::get<double>(param));
@@ -494,7 +601,7 @@ functionCall<FunctionType::erfc>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::tgamma>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::tgamma(std::get<double>(param));
@@ -503,7 +610,7 @@ functionCall<FunctionType::tgamma>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::lgamma>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::lgamma(std::get<double>(param));
@@ -512,7 +619,7 @@ functionCall<FunctionType::lgamma>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::ceil>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::ceil(std::get<double>(param));
@@ -521,7 +628,7 @@ functionCall<FunctionType::ceil>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::floor>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::floor(std::get<double>(param));
@@ -530,7 +637,7 @@ functionCall<FunctionType::floor>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::trunc>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::trunc(std::get<double>(param));
@@ -539,7 +646,7 @@ functionCall<FunctionType::trunc>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::round>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::round(std::get<double>(param));
@@ -548,7 +655,7 @@ functionCall<FunctionType::round>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::nearbyint>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::nearbyint(std::get<double>(param));
@@ -557,7 +664,7 @@ functionCall<FunctionType::nearbyint>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::rint>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::rint(std::get<double>(param));
@@ -566,7 +673,7 @@ functionCall<FunctionType::rint>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::ldexp>(std::variant<int64_t, double>& param1,
                                   std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -575,7 +682,7 @@ functionCall<FunctionType::ldexp>(std::variant<int64_t, double>& param1,
     return std::ldexp(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::scalbn>(std::variant<int64_t, double>& param1,
                                    std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -584,7 +691,7 @@ functionCall<FunctionType::scalbn>(std::variant<int64_t, double>& param1,
     return std::scalbn(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::ilogb>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::ilogb(std::get<double>(param));
@@ -593,7 +700,7 @@ functionCall<FunctionType::ilogb>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::logb>(std::variant<int64_t, double>& param) {
     if (std::holds_alternative<double>(param)) {
         return std::logb(std::get<double>(param));
@@ -602,7 +709,7 @@ functionCall<FunctionType::logb>(std::variant<int64_t, double>& param) {
     }
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::nextafter>(std::variant<int64_t, double>& param1,
                                       std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -611,7 +718,7 @@ functionCall<FunctionType::nextafter>(std::variant<int64_t, double>& param1,
     return std::nextafter(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 template <>
-inline std::variant<int64_t, double>
+EVALUATE_CMATH_CONSTEXPR std::variant<int64_t, double>
 functionCall<FunctionType::copysign>(std::variant<int64_t, double>& param1,
                                      std::variant<int64_t, double>& param2) {
     if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
@@ -830,8 +937,95 @@ functionCall<FunctionType::sph_neumann>(std::variant<int64_t, double>& param1,
     return std::sph_neumann(std::get<int64_t>(param1), std::get<int64_t>(param2));
 }
 
-inline std::variant<int64_t, double> call(FunctionType type,
-                                          std::vector<std::variant<int64_t, double>>& params) {
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::popcount>(std::variant<int64_t, double>& param) {
+    if (std::holds_alternative<double>(param)) {
+        error("Evaluation Error: invalid usage of popcount on floating points");
+    }
+    return popcount(std::get<int64_t>(param));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::clz>(std::variant<int64_t, double>& param) {
+    if (std::holds_alternative<double>(param)) {
+        error("Evaluation Error: invalid usage of clz on floating points");
+    }
+    return clz(std::get<int64_t>(param));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::ctz>(std::variant<int64_t, double>& param) {
+    if (std::holds_alternative<double>(param)) {
+        error("Evaluation Error: invalid usage of ctz on floating points");
+    }
+    return ctz(std::get<int64_t>(param));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::rotl>(std::variant<int64_t, double>& param1,
+                                 std::variant<int64_t, double>& param2) {
+    if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
+        error("Evaluation Error: invalid usage of rotl on floating points");
+    }
+    return rotl(std::get<int64_t>(param1), std::get<int64_t>(param2));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::rotr>(std::variant<int64_t, double>& param1,
+                                 std::variant<int64_t, double>& param2) {
+    if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
+        error("Evaluation Error: invalid usage of rotr on floating points");
+    }
+    return rotr(std::get<int64_t>(param1), std::get<int64_t>(param2));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::bswap>(std::variant<int64_t, double>& param) {
+    if (std::holds_alternative<double>(param)) {
+        error("Evaluation Error: invalid usage of bswap on floating points");
+    }
+    return bswap(std::get<int64_t>(param));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::bextract>(std::variant<int64_t, double>& param1,
+                                     std::variant<int64_t, double>& param2,
+                                     std::variant<int64_t, double>& param3) {
+    if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2) ||
+        std::holds_alternative<double>(param3)) {
+        error("Evaluation Error: invalid usage of bextract on floating points");
+    }
+    return bextract(std::get<int64_t>(param1), std::get<int64_t>(param2),
+                    std::get<int64_t>(param3));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::gcd>(std::variant<int64_t, double>& param1,
+                                std::variant<int64_t, double>& param2) {
+    if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2)) {
+        error("Evaluation Error: invalid usage of gcd on floating points");
+    }
+    return gcd(std::get<int64_t>(param1), std::get<int64_t>(param2));
+}
+template <>
+constexpr std::variant<int64_t, double>
+functionCall<FunctionType::modpow>(std::variant<int64_t, double>& param1,
+                                   std::variant<int64_t, double>& param2,
+                                   std::variant<int64_t, double>& param3) {
+    if (std::holds_alternative<double>(param1) || std::holds_alternative<double>(param2) ||
+        std::holds_alternative<double>(param3)) {
+        error("Evaluation Error: invalid usage of modpow on floating points");
+    }
+    if (std::get<int64_t>(param2) < 0 || std::get<int64_t>(param3) <= 0) {
+        error("Evaluation Error: modpow needs a non-negative exponent and a positive modulus");
+    }
+    return modpow(std::get<int64_t>(param1), std::get<int64_t>(param2),
+                  std::get<int64_t>(param3));
+}
+
+constexpr std::variant<int64_t, double> call(FunctionType type,
+                                             std::span<std::variant<int64_t, double>> params) {
     // ugly hack :(
     switch (type) {
         case FunctionType::abs: {
@@ -1041,12 +1235,40 @@ inline std::variant<int64_t, double> call(FunctionType type,
         case FunctionType::sph_neumann: {
             return functionCall<FunctionType::sph_neumann>(params[0], params[1]);
         }
+        case FunctionType::popcount: {
+            return functionCall<FunctionType::popcount>(params[0]);
+        }
+        case FunctionType::clz: {
+            return functionCall<FunctionType::clz>(params[0]);
+        }
+        case FunctionType::ctz: {
+            return functionCall<FunctionType::ctz>(params[0]);
+        }
+        case FunctionType::rotl: {
+            return functionCall<FunctionType::rotl>(params[0], params[1]);
+        }
+        case FunctionType::rotr: {
+            return functionCall<FunctionType::rotr>(params[0], params[1]);
+        }
+        case FunctionType::bswap: {
+            return functionCall<FunctionType::bswap>(params[0]);
+        }
+        case FunctionType::bextract: {
+            return functionCall<FunctionType::bextract>(params[0], params[1], params[2]);
+        }
+        case FunctionType::gcd: {
+            return functionCall<FunctionType::gcd>(params[0], params[1]);
+        }
+        case FunctionType::modpow: {
+            return functionCall<FunctionType::modpow>(params[0], params[1], params[2]);
+        }
         default: {
             error("unknown error");
         }
     }
 }
-static const std::unordered_map<std::string, FunctionType> functionNames{
+// the functions by name, in the order of FunctionType
+inline constexpr std::pair<std::string_view, FunctionType> functions[]{
     {"abs", FunctionType::abs},
     {"div", FunctionType::div},
     {"fmod", FunctionType::fmod},
@@ -1115,5 +1337,44 @@ static const std::unordered_map<std::string, FunctionType> functionNames{
     {"riemann_zeta", FunctionType::riemann_zeta},
     {"sph_bessel", FunctionType::sph_bessel},
     {"sph_legendre", FunctionType::sph_legendre},
-    {"sph_neumann", FunctionType::sph_neumann}};
+    {"sph_neumann", FunctionType::sph_neumann},
+    {"popcount", FunctionType::popcount},
+    {"clz", FunctionType::clz},
+    {"ctz", FunctionType::ctz},
+    {"rotl", FunctionType::rotl},
+    {"rotr", FunctionType::rotr},
+    {"bswap", FunctionType::bswap},
+    {"bextract", FunctionType::bextract},
+    {"gcd", FunctionType::gcd},
+    {"modpow", FunctionType::modpow}};
+static const std::unordered_map<std::string, FunctionType> functionNames(std::begin(functions),
+                                                                         std::end(functions));
+
+// the function of a name, constexpr unlike functionNames
+constexpr std::optional<FunctionType> functionType(std::string_view name) {
+    for (auto& [n, type] : functions) {
+        if (n == name) {
+            return type;
+        }
+    }
+    return std::nullopt;
+}
+
+// the number of parameters of a function that is only known at runtime
+constexpr int functionParams(FunctionType type) {
+    constexpr auto params = []<size_t... types>(std::index_sequence<types...>) {
+        return std::array{functionParams<static_cast<FunctionType>(types)>()...};
+    }(std::make_index_sequence<std::size(functions)>());
+    return params[static_cast<size_t>(type)];
+}
+
+// the name of a function, for the nodes that are not written in the code
+constexpr std::string_view functionName(FunctionType type) {
+    for (auto& [name, t] : functions) {
+        if (t == type) {
+            return name;
+        }
+    }
+    return "unknown";
+}
 } // namespace evaluate
\ No newline at end of file
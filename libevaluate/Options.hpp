@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace evaluate {
+
+// accuracy of the transcendental functions:
+// standard evaluates every value with <cmath>,
+// precise uses the vectorized kernels that stay within 1 ulp of <cmath>,
+// fast additionally uses kernels with an error of up to 4 ulp
+enum class Accuracy { standard, precise, fast };
+
+// what an integer power does when the result does not fit into int64_t:
+// promote evaluates it again with doubles, error reports an evaluation error
+enum class OverflowPolicy { promote, error };
+
+// strict keeps every double operation exactly as written, so results are bit exact,
+// contract additionally allows a * b + c with a single rounding, i.e. as fma(a, b, c),
+// fast allows every rewrite that changes the rounding, e.g. reassociation, division as
+// multiplication by the reciprocal or log(1 + x) as log1p(x), and assumes there is no -0.0
+enum class FloatPolicy { strict, contract, fast };
+
+// which optimization passes run when an expression is compiled:
+// O0 runs none, for expressions that are only evaluated once,
+// O1 the cheap ones: constant folding, simplification and common subexpressions,
+// O2 additionally Horner form, reassociation and fused functions as far as the FloatPolicy allows
+enum class OptimizationLevel { O0, O1, O2 };
+
+// how an optimized expression is evaluated:
+// tree walks the AST with a visitor,
+// bytecode compiles it into register bytecode for a virtual machine with typed instructions,
+// jit additionally compiles the bytecode into machine code on x86-64 and falls back to bytecode on
+// other architectures,
+// tiered walks the AST without optimizing it first and compiles it like jit with the optimization
+// level on a shared background thread once it was evaluated Options::threshold times
+enum class Backend { tree, bytecode, jit, tiered };
+
+// what a compiled expression keeps of its source:
+// source keeps the source text and the AST, so evaluation errors show where they are in the source,
+// offsets only keeps the offset and length in the source of every operation that can fail, so
+// evaluation errors report these,
+// none keeps neither, evaluation errors report the site of the operation, which is the index into
+// the offsets of the same expression compiled with the same options and Retain::offsets.
+// only bytecode and jit drop the source, tree and tiered evaluate the AST
+enum class Retain { source, offsets, none };
+
+// the options an expression is compiled with, every optimization pass consults them
+struct Options {
+    Accuracy accuracy = Accuracy::standard;
+    OverflowPolicy overflow = OverflowPolicy::promote;
+    FloatPolicy fp = FloatPolicy::strict;
+    OptimizationLevel level = OptimizationLevel::O2;
+    Backend backend = Backend::tree;
+    uint64_t threshold = 1000; // evaluations of Backend::tiered until the expression is compiled
+    Retain retain = Retain::source;
+    std::ostream* dump = nullptr; // prints the AST before and after every pass if set
+
+    // whether a * b + c may be fused into fma(a, b, c)
+    bool contracts() const { return fp != FloatPolicy::strict; }
+    // whether double operations may be rewritten into ones that round differently
+    bool relaxed() const { return fp == FloatPolicy::fast; }
+};
+
+inline std::string_view name(Accuracy accuracy) {
+    switch (accuracy) {
+        case Accuracy::standard: return "standard";
+        case Accuracy::precise: return "precise";
+        default: return "fast";
+    }
+}
+inline std::string_view name(OverflowPolicy overflow) {
+    return overflow == OverflowPolicy::promote ? "promote" : "error";
+}
+inline std::string_view name(FloatPolicy fp) {
+    switch (fp) {
+        case FloatPolicy::strict: return "strict";
+        case FloatPolicy::contract: return "contract";
+        default: return "fast";
+    }
+}
+
+inline std::string_view name(OptimizationLevel level) {
+    switch (level) {
+        case OptimizationLevel::O0: return "O0";
+        case OptimizationLevel::O1: return "O1";
+        default: return "O2";
+    }
+}
+
+inline std::string_view name(Backend backend) {
+    switch (backend) {
+        case Backend::tree: return "tree";
+        case Backend::bytecode: return "bytecode";
+        case Backend::jit: return "jit";
+        default: return "tiered";
+    }
+}
+
+inline std::string_view name(Retain retain) {
+    switch (retain) {
+        case Retain::source: return "source";
+        case Retain::offsets: return "offsets";
+        default: return "none";
+    }
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Options& options) {
+    return os << "accuracy=" << name(options.accuracy) << " overflow=" << name(options.overflow)
+              << " fp=" << name(options.fp) << " level=" << name(options.level)
+              << " backend=" << name(options.backend)
+              << (options.backend == Backend::tiered ? " threshold=" + std::to_string(options.threshold)
+                                                     : "")
+              << (options.retain != Retain::source ? " retain=" + std::string(name(options.retain))
+                                                   : "");
+}
+
+} // namespace evaluate
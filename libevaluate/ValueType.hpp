@@ -0,0 +1,9 @@
+#pragma once
+
+namespace evaluate {
+
+// the type of a value as far as it is known before evaluation:
+// integer and floating values are always int64_t and double, any can be either
+enum class ValueType { integer, floating, any };
+
+} // namespace evaluate
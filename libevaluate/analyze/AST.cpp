@@ -1,6 +1,11 @@
 #include "AST.hpp"
 
 #include "ASTVisitor.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <unordered_set>
 #include <utility>
 
 using namespace std;
@@ -11,19 +16,42 @@ AST::AST(AST::Type type, CodeReference codeRef) : type(type), codeRef(move(codeR
 std::string_view AST::getCode() const { return codeRef.str(); }
 CodeReference AST::getCodeRef() const { return codeRef; }
 AST::Type AST::getType() const { return type; }
+ValueType AST::getValueType() const { return valueType; }
 
-VALUE::VALUE(CodeReference codeRef, int64_t value) : AST(AST::Type::VALUE, codeRef), value(value) {}
-VALUE::VALUE(CodeReference codeRef, double value) : AST(AST::Type::VALUE, codeRef), value(value) {}
+VALUE::VALUE(CodeReference codeRef, int64_t value)
+    : AST(AST::Type::VALUE, codeRef), integer(value) {
+    valueType = ValueType::integer;
+}
+VALUE::VALUE(CodeReference codeRef, double value)
+    : AST(AST::Type::VALUE, codeRef), floating(value) {
+    valueType = ValueType::floating;
+}
 void VALUE::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
-std::variant<int64_t, double> VALUE::getValue() const { return value; }
-bool VALUE::isFP() const { return holds_alternative<double>(value); }
-double VALUE::asDouble() const { return get<double>(value); }
-int64_t VALUE::asInt() const { return get<int64_t>(value); }
+std::variant<int64_t, double> VALUE::getValue() const {
+    return isFP() ? std::variant<int64_t, double>(floating) : std::variant<int64_t, double>(integer);
+}
+bool VALUE::isFP() const { return valueType == ValueType::floating; }
+double VALUE::asDouble() const { return floating; }
+int64_t VALUE::asInt() const { return integer; }
+
+VARIABLE::VARIABLE(CodeReference codeRef, size_t index, string_view name, ValueType valueType)
+    : AST(AST::Type::VARIABLE, codeRef), index(index), name(name) {
+    this->valueType = valueType;
+}
+void VARIABLE::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
+size_t VARIABLE::getIndex() const { return index; }
+std::string_view VARIABLE::getName() const { return name; }
 
 FUNCTION::FUNCTION(CodeReference codeRef, FunctionType functionType, string_view name,
                    std::vector<std::unique_ptr<AST>> parameters)
     : AST(AST::Type::FUNCTION, codeRef), functionType(functionType), name(name),
-      parameters(move(parameters)) {}
+      parameters(move(parameters)) {
+    vector<ValueType> types;
+    for (auto& p : this->parameters) {
+        types.push_back(p->getValueType());
+    }
+    valueType = inferValueType(AST::Type::FUNCTION, functionType, types);
+}
 FunctionType FUNCTION::getFunctionType() const { return functionType; }
 const std::vector<std::unique_ptr<AST>>& FUNCTION::getParameters() const { return parameters; }
 void FUNCTION::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
@@ -31,13 +59,29 @@ std::string_view FUNCTION::getName() const { return name; }
 
 BinaryAST::BinaryAST(AST::Type type, CodeReference codeRef, std::unique_ptr<AST> l_expr,
                      std::unique_ptr<AST> r_expr)
-    : AST(type, move(codeRef)), l_expr(move(l_expr)), r_expr(move(r_expr)) {}
+    : AST(type, move(codeRef)), l_expr(move(l_expr)), r_expr(move(r_expr)) {
+    array types{this->l_expr->getValueType(), this->r_expr->getValueType()};
+    valueType = inferValueType(type, {}, types);
+}
 const AST& BinaryAST::getLExpr() const { return *l_expr; }
 const AST& BinaryAST::getRExpr() const { return *r_expr; }
+Quickening BinaryAST::getQuickening() const { return quickening.load(memory_order_relaxed); }
+void BinaryAST::quicken(Quickening quickening) const {
+    this->quickening.store(quickening, memory_order_relaxed);
+}
 
 POW::POW(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr)
-    : BinaryAST(AST::Type::POW, move(codeRef), move(l_expr), move(r_expr)) {}
+    : BinaryAST(AST::Type::POW, move(codeRef), move(l_expr), move(r_expr)),
+      integerPower(nullptr) {
+    if (this->r_expr->getType() == AST::Type::VALUE) {
+        auto& exponent = static_cast<const VALUE&>(*this->r_expr);
+        if (!exponent.isFP()) {
+            integerPower = evaluate::integerPower(exponent.asInt());
+        }
+    }
+}
 void POW::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
+IntegerPower POW::getIntegerPower() const { return integerPower; }
 
 OR::OR(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr)
     : BinaryAST(AST::Type::OR, move(codeRef), move(l_expr), move(r_expr)) {}
@@ -71,16 +115,152 @@ MUL::MUL(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST
     : BinaryAST(AST::Type::MUL, move(codeRef), move(l_expr), move(r_expr)) {}
 void MUL::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
 
+static optional<SignedDivisor> signedDivisor(const AST& divisor) {
+    if (divisor.getType() == AST::Type::VALUE) {
+        auto& value = static_cast<const VALUE&>(divisor);
+        if (!value.isFP() && value.asInt() != 0 && value.asInt() != 1 && value.asInt() != -1) {
+            return SignedDivisor(value.asInt());
+        }
+    }
+    return nullopt;
+}
+
 DIV::DIV(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr)
-    : BinaryAST(AST::Type::DIV, move(codeRef), move(l_expr), move(r_expr)) {}
+    : BinaryAST(AST::Type::DIV, move(codeRef), move(l_expr), move(r_expr)),
+      divisor(signedDivisor(*this->r_expr)) {
+    if (this->r_expr->getType() == AST::Type::VALUE) {
+        double value = getAsDouble(static_cast<const VALUE&>(*this->r_expr).getValue());
+        // tiny divisors have no finite reciprocal, e.g. 1 / 2 ** -1074
+        if (value != 0 && isfinite(value) && isfinite(1 / value)) {
+            reciprocal = 1 / value;
+            // a power of two whose reciprocal is normal
+            int exponent;
+            exactReciprocal = abs(frexp(value, &exponent)) == 0.5 && exponent >= -1022 &&
+                              exponent <= 1023;
+        }
+    }
+}
 void DIV::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
+const optional<SignedDivisor>& DIV::getDivisor() const { return divisor; }
+optional<double> DIV::getReciprocal() const { return reciprocal; }
+bool DIV::isExactReciprocal() const { return exactReciprocal; }
 
 MOD::MOD(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr)
-    : BinaryAST(AST::Type::MOD, move(codeRef), move(l_expr), move(r_expr)) {}
+    : BinaryAST(AST::Type::MOD, move(codeRef), move(l_expr), move(r_expr)),
+      divisor(signedDivisor(*this->r_expr)) {}
 void MOD::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
+const optional<SignedDivisor>& MOD::getDivisor() const { return divisor; }
+
+SHARED::SHARED(CodeReference codeRef, size_t index, shared_ptr<const AST> expression)
+    : AST(AST::Type::SHARED, move(codeRef)), index(index), expression(move(expression)) {
+    valueType = this->expression->getValueType();
+}
+void SHARED::accept(ASTVisitor& visitor) const { visitor.visit(*this); }
+size_t SHARED::getIndex() const { return index; }
+const AST& SHARED::getExpression() const { return *expression; }
+const shared_ptr<const AST>& SHARED::getSharedExpression() const { return expression; }
+
+bool isDouble(const AST& node) { return node.getValueType() == ValueType::floating; }
+bool isInteger(const AST& node) { return node.getValueType() == ValueType::integer; }
+
+bool equal(const AST& a, const AST& b) {
+    if (a.getType() == AST::Type::SHARED) {
+        return equal(static_cast<const SHARED&>(a).getExpression(), b);
+    }
+    if (b.getType() == AST::Type::SHARED) {
+        return equal(a, static_cast<const SHARED&>(b).getExpression());
+    }
+    if (a.getType() != b.getType()) {
+        return false;
+    }
+    switch (a.getType()) {
+        case AST::Type::VALUE: {
+            auto &x = static_cast<const VALUE&>(a), &y = static_cast<const VALUE&>(b);
+            return x.isFP() == y.isFP() && (x.isFP() ? bit_cast<int64_t>(x.asDouble()) ==
+                                                           bit_cast<int64_t>(y.asDouble()) :
+                                                       x.asInt() == y.asInt());
+        }
+        case AST::Type::VARIABLE:
+            return static_cast<const VARIABLE&>(a).getIndex() ==
+                   static_cast<const VARIABLE&>(b).getIndex();
+        case AST::Type::FUNCTION: {
+            auto &x = static_cast<const FUNCTION&>(a), &y = static_cast<const FUNCTION&>(b);
+            return x.getFunctionType() == y.getFunctionType() &&
+                   equal(x.getParameters().begin(), x.getParameters().end(),
+                         y.getParameters().begin(), y.getParameters().end(),
+                         [](auto& p, auto& q) { return evaluate::equal(*p, *q); });
+        }
+        case AST::Type::UnaryMINUS:
+        case AST::Type::UnaryPLUS:
+        case AST::Type::UnaryCOMP:
+            return equal(static_cast<const UnaryAST&>(a).getChild(),
+                         static_cast<const UnaryAST&>(b).getChild());
+        default: {
+            auto &x = static_cast<const BinaryAST&>(a), &y = static_cast<const BinaryAST&>(b);
+            return equal(x.getLExpr(), y.getLExpr()) && equal(x.getRExpr(), y.getRExpr());
+        }
+    }
+}
+
+bool dependsOn(const AST& node, size_t variable) {
+    switch (node.getType()) {
+        case AST::Type::VALUE: return false;
+        case AST::Type::VARIABLE: return static_cast<const VARIABLE&>(node).getIndex() == variable;
+        case AST::Type::FUNCTION:
+            return any_of(static_cast<const FUNCTION&>(node).getParameters().begin(),
+                          static_cast<const FUNCTION&>(node).getParameters().end(),
+                          [&](auto& p) { return dependsOn(*p, variable); });
+        case AST::Type::SHARED:
+            return dependsOn(static_cast<const SHARED&>(node).getExpression(), variable);
+        case AST::Type::UnaryMINUS:
+        case AST::Type::UnaryPLUS:
+        case AST::Type::UnaryCOMP:
+            return dependsOn(static_cast<const UnaryAST&>(node).getChild(), variable);
+        default: {
+            auto& binary = static_cast<const BinaryAST&>(node);
+            return dependsOn(binary.getLExpr(), variable) || dependsOn(binary.getRExpr(), variable);
+        }
+    }
+}
+
+static size_t countNodes(const AST& node, unordered_set<size_t>& shared) {
+    switch (node.getType()) {
+        case AST::Type::VALUE:
+        case AST::Type::VARIABLE: return 1;
+        case AST::Type::FUNCTION: {
+            size_t count = 1;
+            for (auto& p : static_cast<const FUNCTION&>(node).getParameters()) {
+                count += countNodes(*p, shared);
+            }
+            return count;
+        }
+        case AST::Type::SHARED: {
+            auto& expression = static_cast<const SHARED&>(node);
+            return 1 + (shared.insert(expression.getIndex()).second ?
+                            countNodes(expression.getExpression(), shared) :
+                            0);
+        }
+        case AST::Type::UnaryMINUS:
+        case AST::Type::UnaryPLUS:
+        case AST::Type::UnaryCOMP:
+            return 1 + countNodes(static_cast<const UnaryAST&>(node).getChild(), shared);
+        default: {
+            auto& binary = static_cast<const BinaryAST&>(node);
+            return 1 + countNodes(binary.getLExpr(), shared) +
+                   countNodes(binary.getRExpr(), shared);
+        }
+    }
+}
+size_t countNodes(const AST& node) {
+    unordered_set<size_t> shared{};
+    return countNodes(node, shared);
+}
 
 UnaryAST::UnaryAST(AST::Type type, CodeReference codeRef, std::unique_ptr<AST> child)
-    : AST(type, move(codeRef)), child(move(child)) {}
+    : AST(type, move(codeRef)), child(move(child)) {
+    array types{this->child->getValueType()};
+    valueType = inferValueType(type, {}, types);
+}
 const AST& UnaryAST::getChild() const { return *child; }
 
 UnaryMINUS::UnaryMINUS(CodeReference codeRef, std::unique_ptr<AST> child)
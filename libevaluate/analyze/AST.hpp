@@ -2,10 +2,16 @@
 
 #include "ASTVisitor.hpp"
 #include "Functions.hpp"
+#include "ValueType.hpp"
+#include "math/Integer.hpp"
 #include "parse/Node.hpp"
 #include "parse/Parser.hpp"
 #include "util/Code.hpp"
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <variant>
 #include <vector>
 
@@ -15,6 +21,7 @@ class AST {
     public:
     enum class Type {
         VALUE,
+        VARIABLE,
         FUNCTION,
         POW,
         OR,
@@ -29,13 +36,17 @@ class AST {
         MOD,
         UnaryMINUS,
         UnaryPLUS,
-        UnaryCOMP
+        UnaryCOMP,
+        SHARED
     };
 
     private:
     const AST::Type type;
     const CodeReference codeRef;
 
+    protected:
+    ValueType valueType = ValueType::any; // inferred from the operands by the constructors
+
     public:
     AST(AST::Type type, CodeReference codeRef);
     virtual ~AST() noexcept = default;
@@ -44,11 +55,72 @@ class AST {
     std::string_view getCode() const;
     CodeReference getCodeRef() const;
     AST::Type getType() const;
+    ValueType getValueType() const;
 };
 
+// the value type of a node with operands of the given value types: the parameters of a FUNCTION,
+// the operands of a binary node or the child of a unary node. constexpr for the parser of ce
+constexpr ValueType inferValueType(AST::Type type, FunctionType function,
+                                   std::span<const ValueType> operands) {
+    // a unary node has the type of its child, except ~ which is integer
+    if (operands.size() == 1 && (type == AST::Type::UnaryMINUS || type == AST::Type::UnaryPLUS)) {
+        return operands[0];
+    }
+    // the type of an arithmetic operation, any double operand makes the result a double
+    auto arithmetic = [&] {
+        if (operands.size() != 2) {
+            return ValueType::any;
+        } else if (operands[0] == ValueType::floating || operands[1] == ValueType::floating) {
+            return ValueType::floating;
+        } else if (operands[0] == ValueType::integer && operands[1] == ValueType::integer) {
+            return ValueType::integer;
+        } else {
+            return ValueType::any;
+        }
+    };
+    switch (type) {
+        case AST::Type::FUNCTION: {
+            switch (function) {
+                // the integer functions and div report an error for doubles, ilogb returns an int
+                // anyway
+                case FunctionType::div:
+                case FunctionType::ilogb: return ValueType::integer;
+                case FunctionType::abs: return operands.empty() ? ValueType::any : operands[0];
+                // a power of integers is promoted to double when it overflows
+                case FunctionType::pow: {
+                    for (auto operand : operands) {
+                        if (operand == ValueType::floating) {
+                            return ValueType::floating;
+                        }
+                    }
+                    return ValueType::any;
+                }
+                default: {
+                    return isIntegerFunction(function) ? ValueType::integer : ValueType::floating;
+                }
+            }
+        }
+        // bitwise operators report an error for doubles
+        case AST::Type::OR:
+        case AST::Type::XOR:
+        case AST::Type::AND:
+        case AST::Type::SHL:
+        case AST::Type::SHR:
+        case AST::Type::UnaryCOMP: return ValueType::integer;
+        // a power of integers is promoted to double when it overflows
+        case AST::Type::POW:
+            return arithmetic() == ValueType::floating ? ValueType::floating : ValueType::any;
+        default: return arithmetic();
+    }
+}
+
 class VALUE : public AST {
     private:
-    std::variant<int64_t, double> value;
+    // the value type of the node tells which member holds the value
+    union {
+        int64_t integer;
+        double floating;
+    };
 
     public:
     VALUE(CodeReference codeRef, int64_t value);
@@ -61,6 +133,19 @@ class VALUE : public AST {
     int64_t asInt() const;
     bool isFP() const;
 };
+class VARIABLE : public AST {
+    private:
+    size_t index;
+    std::string_view name;
+
+    public:
+    VARIABLE(CodeReference codeRef, size_t index, std::string_view name,
+             ValueType valueType = ValueType::any);
+
+    void accept(ASTVisitor& visitor) const override;
+    size_t getIndex() const;
+    std::string_view getName() const;
+};
 class FUNCTION : public AST {
     private:
     FunctionType functionType;
@@ -77,10 +162,20 @@ class FUNCTION : public AST {
     const std::vector<std::unique_ptr<AST>>& getParameters() const;
 };
 
+// the operand types the tree-walker saw at a BinaryAST without a known type. the first
+// evaluation specializes the node on its operand types, later evaluations only compare their
+// types with them and deoptimize the node for good if they differ.
+// the specialized ones are the variant indices of the operands as l << 1 | r
+enum class Quickening : uint8_t { integers, integerDouble, doubleInteger, doubles, none, generic };
+
 class BinaryAST : public AST {
     protected:
     std::unique_ptr<AST> l_expr;
     std::unique_ptr<AST> r_expr;
+    // profiled while the AST is evaluated. relaxed atomic, since the specializations of an
+    // Evaluator share subexpressions and can be evaluated on other threads. a stale value only
+    // fails the guard or deoptimizes the node, the result is the same
+    mutable std::atomic<Quickening> quickening = Quickening::none;
 
     public:
     BinaryAST(AST::Type type, CodeReference codeRef, std::unique_ptr<AST> l_expr,
@@ -88,12 +183,18 @@ class BinaryAST : public AST {
 
     const AST& getLExpr() const;
     const AST& getRExpr() const;
+    Quickening getQuickening() const;
+    void quicken(Quickening quickening) const;
 };
 class POW : public BinaryAST {
+    private:
+    IntegerPower integerPower; // for a constant integer exponent, otherwise nullptr
+
     public:
     POW(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr);
 
     void accept(ASTVisitor& visitor) const override;
+    IntegerPower getIntegerPower() const;
 };
 class OR : public BinaryAST {
     public:
@@ -144,16 +245,28 @@ class MUL : public BinaryAST {
     void accept(ASTVisitor& visitor) const override;
 };
 class DIV : public BinaryAST {
+    private:
+    std::optional<SignedDivisor> divisor; // for a constant integer divisor
+    std::optional<double> reciprocal; // for any constant divisor
+    bool exactReciprocal = false; // multiplying by reciprocal rounds like dividing
+
     public:
     DIV(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr);
 
     void accept(ASTVisitor& visitor) const override;
+    const std::optional<SignedDivisor>& getDivisor() const;
+    std::optional<double> getReciprocal() const;
+    bool isExactReciprocal() const;
 };
 class MOD : public BinaryAST {
+    private:
+    std::optional<SignedDivisor> divisor; // for a constant integer divisor
+
     public:
     MOD(CodeReference codeRef, std::unique_ptr<AST> l_expr, std::unique_ptr<AST> r_expr);
 
     void accept(ASTVisitor& visitor) const override;
+    const std::optional<SignedDivisor>& getDivisor() const;
 };
 class UnaryAST : public AST {
     protected:
@@ -182,5 +295,30 @@ class UnaryCOMP : public UnaryAST {
 
     void accept(ASTVisitor& visitor) const override;
 };
+// an expression that occurs more than once, every occurrence refers to the same expression.
+// index numbers the shared expressions of an AST, so evaluators can store their values
+class SHARED : public AST {
+    private:
+    size_t index;
+    std::shared_ptr<const AST> expression;
+
+    public:
+    SHARED(CodeReference codeRef, size_t index, std::shared_ptr<const AST> expression);
+
+    void accept(ASTVisitor& visitor) const override;
+    size_t getIndex() const;
+    const AST& getExpression() const;
+    const std::shared_ptr<const AST>& getSharedExpression() const;
+};
+
+// whether the value of node is always a double or an integer
+bool isDouble(const AST& node);
+bool isInteger(const AST& node);
+// whether a and b are the same expression
+bool equal(const AST& a, const AST& b);
+// whether the value of node depends on the variable with the given index
+bool dependsOn(const AST& node, size_t variable);
+// the number of nodes that are evaluated, a shared expression is only counted once
+size_t countNodes(const AST& node);
 
 } // namespace evaluate
@@ -1,22 +1,25 @@
 #include "ASTPrinter.hpp"
 #include "AST.hpp"
-#include <iostream>
+#include <ostream>
 
 using namespace std;
 
 namespace evaluate {
 
-ASTPrinter::ASTPrinter(const Code& code) : code(code) {}
+ASTPrinter::ASTPrinter(const Code& code, ostream& os) : code(code), os(os) {}
 
 void ASTPrinter::visit(const VALUE& node) {
-    cout << count << " [label=\"" << (node.isFP() ? node.asDouble() : node.asInt())
+    os << count << " [label=\"" << (node.isFP() ? node.asDouble() : node.asInt())
          << (node.isFP() ? 'd' : 'i') << "\"]" << endl;
 }
+void ASTPrinter::visit(const VARIABLE& node) {
+    os << count << " [label=\"" << node.getName() << "\"]" << endl;
+}
 void ASTPrinter::visit(const FUNCTION& node) {
     size_t id = count;
-    cout << count << " [label=\"" << node.getName() << "\"]" << endl;
+    os << count << " [label=\"" << node.getName() << "\"]" << endl;
     for (auto& param: node.getParameters()) {
-        cout << id << " -> " << ++count << endl;
+        os << id << " -> " << ++count << endl;
         param->accept(*this);
     }
 }
@@ -24,11 +27,11 @@ template <typename ast, const char* op>
 requires std::derived_from<ast, BinaryAST>
 void ASTPrinter::visitBinaryAST(const ast& node) {
     size_t id = count;
-    cout << count << " [label=\"" << op << "\"]" << endl;
+    os << count << " [label=\"" << op << "\"]" << endl;
+    os << id << " -> " << ++count << endl;
     node.getLExpr().accept(*this);
-    cout << id << " -> " << ++count << endl;
+    os << id << " -> " << ++count << endl;
     node.getRExpr().accept(*this);
-    cout << id << " -> " << ++count << endl;
 }
 void ASTPrinter::visit(const POW& node) {
     static const char op[] = "**";
@@ -78,9 +81,9 @@ template <typename ast, const char* op>
 requires std::derived_from<ast, UnaryAST>
 void ASTPrinter::visitUnaryAST(const ast& node) {
     size_t id = count;
-    cout << count << " [label=\"" << op << "\"]" << endl;
+    os << count << " [label=\"" << op << "\"]" << endl;
+    os << id << " -> " << ++count << endl;
     node.getChild().accept(*this);
-    cout << id << " -> " << ++count << endl;
 }
 void ASTPrinter::visit(const UnaryMINUS& node) {
     static const char op[] = "-";
@@ -94,5 +97,11 @@ void ASTPrinter::visit(const UnaryCOMP& node) {
     static const char op[] = "~";
     visitUnaryAST<UnaryCOMP, op>(node);
 }
+void ASTPrinter::visit(const SHARED& node) {
+    size_t id = count;
+    os << count << " [label=\"#" << node.getIndex() << "\"]" << endl;
+    os << id << " -> " << ++count << endl;
+    node.getExpression().accept(*this);
+}
 
 } // namespace evaluate
@@ -4,17 +4,21 @@
 #include "util/Code.hpp"
 #include "AST.hpp"
 #include <concepts>
+#include <iostream>
 
 namespace evaluate {
 
 class ASTPrinter : public ASTVisitor {
     private:
     const Code& code;
+    std::ostream& os;
     size_t count = 0;
 
     public:
-    explicit ASTPrinter(const Code& code);
+    // prints the nodes and edges of a graphviz digraph
+    explicit ASTPrinter(const Code& code, std::ostream& os = std::cout);
     void visit(const VALUE& node) override;
+    void visit(const VARIABLE& node) override;
     void visit(const FUNCTION& node) override;
     void visit(const POW& node) override;
     void visit(const OR& node) override;
@@ -30,6 +34,7 @@ class ASTPrinter : public ASTVisitor {
     void visit(const UnaryMINUS& node) override;
     void visit(const UnaryPLUS& node) override;
     void visit(const UnaryCOMP& node) override;
+    void visit(const SHARED& node) override;
 
     private:
     template<typename ast, const char* op>
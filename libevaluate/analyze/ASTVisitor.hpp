@@ -3,6 +3,7 @@
 namespace evaluate {
 
 class VALUE;
+class VARIABLE;
 class FUNCTION;
 class POW;
 class OR;
@@ -18,10 +19,12 @@ class MOD;
 class UnaryMINUS;
 class UnaryPLUS;
 class UnaryCOMP;
+class SHARED;
 
 class ASTVisitor {
     public:
     virtual void visit(const VALUE& node) = 0;
+    virtual void visit(const VARIABLE& node) = 0;
     virtual void visit(const FUNCTION& node) = 0;
     virtual void visit(const POW& node) = 0;
     virtual void visit(const OR& node) = 0;
@@ -37,6 +40,7 @@ class ASTVisitor {
     virtual void visit(const UnaryMINUS& node) = 0;
     virtual void visit(const UnaryPLUS& node) = 0;
     virtual void visit(const UnaryCOMP& node) = 0;
+    virtual void visit(const SHARED& node) = 0;
 };
 
 } // namespace evaluate
\ No newline at end of file
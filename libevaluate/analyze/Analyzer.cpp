@@ -2,6 +2,7 @@
 #include "Functions.hpp"
 #include "parse/Parser.hpp"
 #include "util/Error.hpp"
+#include <algorithm>
 #include <cassert>
 #include <unordered_map>
 
@@ -9,7 +10,8 @@ using namespace std;
 
 namespace evaluate {
 
-Analyzer::Analyzer(const Code& code) : code(code) {}
+Analyzer::Analyzer(const Code& code, span<const string> variables, span<const ValueType> types)
+    : code(code), variables(variables), types(types) {}
 
 unique_ptr<AST> Analyzer::analyze() {
     Parser parser(code);
@@ -19,7 +21,22 @@ unique_ptr<AST> Analyzer::analyze() {
 }
 void Analyzer::visit(const GenericToken&) { __builtin_unreachable(); }
 void Analyzer::visit(const Literal& node) {
-    reg = make_unique<VALUE>(node.getCodeRef(), node.isFP() ? node.asDouble() : node.asInt());
+    if (node.isFP()) {
+        reg = make_unique<VALUE>(node.getCodeRef(), node.asDouble());
+    } else {
+        reg = make_unique<VALUE>(node.getCodeRef(), node.asInt());
+    }
+}
+void Analyzer::visit(const Variable& node) {
+    const auto variable = find(variables.begin(), variables.end(), node.getName());
+    if (variable == variables.end()) {
+        error(node.getCodeRef().getFrom(), node.getCode().size(), code,
+              "Semantic Error: unknown variable name");
+    } else {
+        size_t index = variable - variables.begin();
+        reg = make_unique<VARIABLE>(node.getCodeRef(), index, node.getName(),
+                                    types.empty() ? ValueType::any : types[index]);
+    }
 }
 void Analyzer::visit(const Function& node) {
     const auto type = functionNames.find(string(node.getName()));
@@ -33,6 +50,10 @@ void Analyzer::visit(const Function& node) {
                 continue;
             }
             ptr->accept(*this);
+            if (isIntegerFunction(type->second) && isDouble(*reg)) {
+                error(ptr->getCodeRef().getFrom(), ptr->getCode().size(), code,
+                      "Semantic Error: integer function called with a floating point argument");
+            }
             parameters.emplace_back(move(reg));
         }
         reg = make_unique<FUNCTION>(node.getCodeRef(), type->second, node.getName(),
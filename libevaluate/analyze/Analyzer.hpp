@@ -5,21 +5,27 @@
 #include "parse/NodeVisitor.hpp"
 #include <memory>
 #include <concepts>
+#include <span>
+#include <string>
 
 namespace evaluate {
 
 class Analyzer : public NodeVisitor {
     private:
     const Code& code;
+    std::span<const std::string> variables;
+    std::span<const ValueType> types; // of the variables, all any if empty
     std::unique_ptr<AST> reg;
 
     public:
-    explicit Analyzer(const Code& code);
+    explicit Analyzer(const Code& code, std::span<const std::string> variables = {},
+                      std::span<const ValueType> types = {});
 
     std::unique_ptr<AST> analyze();
 
     void visit(const GenericToken& node) override;
     void visit(const Literal& node) override;
+    void visit(const Variable& node) override;
     void visit(const Function& node) override;
     void visit(const Primary& node) override;
 
@@ -0,0 +1,229 @@
+#include "CodeGenerator.hpp"
+#include "Evaluator.hpp"
+#include "Functions.hpp"
+#include "analyze/AST.hpp"
+#include "math/VectorMath.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace evaluate {
+
+static string_view cppType(ValueType type) {
+    switch (type) {
+        case ValueType::integer: return "int64_t";
+        case ValueType::floating: return "double";
+        default: return "evaluate::aot::Value";
+    }
+}
+static string literal(int64_t value) {
+    if (value == numeric_limits<int64_t>::min()) {
+        return "INT64_MIN";
+    }
+    return "int64_t{" + to_string(value) + "}";
+}
+// hexadecimal literals are exact
+static string literal(double value) {
+    ostringstream os;
+    if (isfinite(value)) {
+        os << hexfloat << value;
+    } else {
+        os << "std::bit_cast<double>(uint64_t{" << bit_cast<uint64_t>(value) << "u})";
+    }
+    return os.str();
+}
+
+CodeGenerator::CodeGenerator(const Evaluator& evaluator)
+    : evaluator(evaluator), options(evaluator.getOptions()),
+      shared(evaluator.getSharingStatistics().expressions) {}
+
+string CodeGenerator::generate(string_view name) {
+    string result = operand(evaluator.getAST());
+    auto& variables = evaluator.getVariables();
+    auto& types = evaluator.getTypes();
+    ostringstream function;
+    function << (integral ? "constexpr " : "inline ") << cppType(evaluator.getAST().getValueType())
+             << ' ' << name << '(';
+    for (size_t i = 0; i < variables.size(); ++i) {
+        function << (i ? ", " : "") << "[[maybe_unused]] " << cppType(types[i]) << ' '
+                 << variables[i];
+    }
+    function << ") {\n" << body.str() << "    return " << result << ";\n}\n";
+    return function.str();
+}
+
+string CodeGenerator::operand(const AST& node) {
+    node.accept(*this);
+    if (node.getValueType() != ValueType::integer) {
+        integral = false;
+    }
+    return reg;
+}
+string CodeGenerator::doubleOperand(const AST& node) {
+    if (node.getType() == AST::Type::VALUE) {
+        integral = false;
+        auto& value = static_cast<const VALUE&>(node);
+        return literal(value.isFP() ? value.asDouble() : static_cast<double>(value.asInt()));
+    }
+    string r = operand(node);
+    switch (node.getValueType()) {
+        case ValueType::integer: return "static_cast<double>(" + r + ")";
+        case ValueType::floating: return r;
+        default: return "evaluate::aot::toDouble(" + r + ")";
+    }
+}
+string CodeGenerator::integerOperand(const AST& node) {
+    string r = operand(node);
+    if (node.getValueType() == ValueType::integer) {
+        return r;
+    }
+    return "evaluate::aot::integer(" + r + ")";
+}
+void CodeGenerator::local(const AST& node, const string& expression) {
+    reg = "_t" + to_string(locals++);
+    body << "    const " << cppType(node.getValueType()) << ' ' << reg << " = " << expression
+         << ";\n";
+}
+
+void CodeGenerator::visit(const evaluate::VALUE& node) {
+    reg = node.isFP() ? literal(node.asDouble()) : literal(node.asInt());
+}
+void CodeGenerator::visit(const evaluate::VARIABLE& node) {
+    reg = evaluator.getVariables()[node.getIndex()];
+}
+// like the Evaluator, functions with a kernel for the accuracy use it, other functions of doubles
+// call <cmath> and the rest checks the types of the parameters when it is called
+void CodeGenerator::visit(const evaluate::FUNCTION& node) {
+    integral = false;
+    auto type = node.getFunctionType();
+    auto& parameters = node.getParameters();
+    string function(functionName(type));
+    string arguments;
+    auto append = [&arguments](const string& argument) {
+        arguments += (arguments.empty() ? "" : ", ") + argument;
+    };
+    bool doubles = all_of(parameters.begin(), parameters.end(), [](auto& parameter) {
+        return parameter->getValueType() == ValueType::floating;
+    });
+    if (node.getValueType() == ValueType::floating && simd::hasKernel(type, options.accuracy) &&
+        parameters.size() <= 3) {
+        for (auto& parameter : parameters) {
+            append(doubleOperand(*parameter));
+        }
+        local(node, "evaluate::aot::kernel(evaluate::FunctionType::" + function +
+                        ", evaluate::Accuracy::" + string(name(options.accuracy)) + ", {" +
+                        arguments + "})");
+        return;
+    }
+    if (!simd::hasKernel(type, options.accuracy) && isCmathFunction(type) && doubles) {
+        for (auto& parameter : parameters) {
+            append(operand(*parameter));
+        }
+        local(node, "std::" + (type == FunctionType::abs ? "fabs" : function) + "(" + arguments +
+                        ")");
+        return;
+    }
+    for (auto& parameter : parameters) {
+        append(operand(*parameter));
+    }
+    string call = "evaluate::aot::call(evaluate::FunctionType::" + function +
+                  ", evaluate::Accuracy::" + string(name(options.accuracy)) +
+                  ", evaluate::OverflowPolicy::" + string(name(options.overflow)) + ", {" +
+                  arguments + "})";
+    switch (node.getValueType()) {
+        case ValueType::integer: local(node, "std::get<int64_t>(" + call + ")"); break;
+        case ValueType::floating: local(node, "std::get<double>(" + call + ")"); break;
+        default: local(node, call);
+    }
+}
+void CodeGenerator::visit(const evaluate::POW& node) {
+    if (node.getValueType() == ValueType::floating) {
+        string base = doubleOperand(node.getLExpr());
+        local(node, "std::pow(" + base + ", " + doubleOperand(node.getRExpr()) + ")");
+        return;
+    }
+    string base = operand(node.getLExpr());
+    string exponent = operand(node.getRExpr());
+    local(node, "evaluate::aot::power(" + base + ", " + exponent + ", evaluate::OverflowPolicy::" +
+                    string(name(options.overflow)) + ")");
+}
+
+void CodeGenerator::visitArithmetic(const BinaryAST& node, string_view op, string_view function) {
+    switch (node.getValueType()) {
+        case ValueType::integer: {
+            string l = operand(node.getLExpr());
+            local(node, l + " " + string(op) + " " + operand(node.getRExpr()));
+            break;
+        }
+        case ValueType::floating: {
+            string l = doubleOperand(node.getLExpr());
+            local(node, l + " " + string(op) + " " + doubleOperand(node.getRExpr()));
+            break;
+        }
+        default: {
+            string l = operand(node.getLExpr());
+            string r = operand(node.getRExpr());
+            local(node, "evaluate::aot::" + string(function) + "(" + l + ", " + r + ")");
+        }
+    }
+}
+void CodeGenerator::visitBitwise(const BinaryAST& node, string_view op) {
+    string l = integerOperand(node.getLExpr());
+    local(node, l + " " + string(op) + " " + integerOperand(node.getRExpr()));
+}
+
+void CodeGenerator::visit(const evaluate::OR& node) { visitBitwise(node, "|"); }
+void CodeGenerator::visit(const evaluate::XOR& node) { visitBitwise(node, "^"); }
+void CodeGenerator::visit(const evaluate::AND& node) { visitBitwise(node, "&"); }
+void CodeGenerator::visit(const evaluate::SHL& node) { visitBitwise(node, "<<"); }
+void CodeGenerator::visit(const evaluate::SHR& node) { visitBitwise(node, ">>"); }
+void CodeGenerator::visit(const evaluate::ADD& node) { visitArithmetic(node, "+", "add"); }
+void CodeGenerator::visit(const evaluate::MINUS& node) { visitArithmetic(node, "-", "subtract"); }
+void CodeGenerator::visit(const evaluate::MUL& node) { visitArithmetic(node, "*", "multiply"); }
+void CodeGenerator::visit(const evaluate::DIV& node) {
+    auto reciprocal = node.getReciprocal();
+    if (!reciprocal || !(node.isExactReciprocal() || options.relaxed())) {
+        visitArithmetic(node, "/", "divide");
+    } else if (node.getValueType() == ValueType::floating) {
+        local(node, doubleOperand(node.getLExpr()) + " * " + literal(*reciprocal));
+    } else if (node.getValueType() == ValueType::integer) {
+        visitArithmetic(node, "/", "divide");
+    } else {
+        string l = operand(node.getLExpr());
+        string r = operand(node.getRExpr());
+        local(node, "evaluate::aot::divide(" + l + ", " + r + ", " + literal(*reciprocal) + ")");
+    }
+}
+void CodeGenerator::visit(const evaluate::MOD& node) {
+    if (node.getValueType() == ValueType::floating) {
+        string l = doubleOperand(node.getLExpr());
+        local(node, "std::fmod(" + l + ", " + doubleOperand(node.getRExpr()) + ")");
+        return;
+    }
+    visitArithmetic(node, "%", "modulo");
+}
+void CodeGenerator::visit(const evaluate::UnaryMINUS& node) {
+    switch (node.getValueType()) {
+        case ValueType::integer: local(node, "-(" + operand(node.getChild()) + ")"); break;
+        case ValueType::floating: local(node, "-(" + doubleOperand(node.getChild()) + ")"); break;
+        default: local(node, "evaluate::aot::negate(" + operand(node.getChild()) + ")");
+    }
+}
+// the child has the same type
+void CodeGenerator::visit(const evaluate::UnaryPLUS& node) { node.getChild().accept(*this); }
+void CodeGenerator::visit(const evaluate::UnaryCOMP& node) {
+    local(node, "~(" + integerOperand(node.getChild()) + ")");
+}
+void CodeGenerator::visit(const evaluate::SHARED& node) {
+    auto& local = shared[node.getIndex()];
+    if (!local) {
+        local = operand(node.getExpression());
+    }
+    reg = *local;
+}
+
+} // namespace evaluate
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Options.hpp"
+#include "ValueType.hpp"
+#include "analyze/ASTVisitor.hpp"
+#include <cstddef>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace evaluate {
+class AST;
+class BinaryAST;
+class Evaluator;
+
+// generates a C++ function that evaluates the optimized AST of an Evaluator like the Evaluator,
+// with a parameter for every variable. every node becomes a local of the C++ type of its value
+// type, so the C++ compiler sees the whole expression and nodes without a known type use
+// aot/Runtime.hpp. functions that only work on integers are constexpr
+class CodeGenerator : private ASTVisitor {
+    private:
+    const Evaluator& evaluator;
+    const Options& options;
+    std::ostringstream body;
+    std::vector<std::optional<std::string>> shared; // the local of every shared expression
+    size_t locals = 0;
+    bool integral = true; // whether the function only works on integers
+    std::string reg;      // the C++ expression with the value of the visited node
+
+    public:
+    explicit CodeGenerator(const Evaluator& evaluator);
+    std::string generate(std::string_view name);
+
+    private:
+    void visit(const VALUE& node) override;
+    void visit(const VARIABLE& node) override;
+    void visit(const FUNCTION& node) override;
+    void visit(const POW& node) override;
+    void visit(const OR& node) override;
+    void visit(const XOR& node) override;
+    void visit(const AND& node) override;
+    void visit(const SHL& node) override;
+    void visit(const SHR& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+    void visit(const MUL& node) override;
+    void visit(const DIV& node) override;
+    void visit(const MOD& node) override;
+    void visit(const UnaryMINUS& node) override;
+    void visit(const UnaryPLUS& node) override;
+    void visit(const UnaryCOMP& node) override;
+    void visit(const SHARED& node) override;
+
+    std::string operand(const AST& node);
+    std::string doubleOperand(const AST& node);
+    std::string integerOperand(const AST& node);
+    // declares a local for the value of node
+    void local(const AST& node, const std::string& expression);
+
+    void visitArithmetic(const BinaryAST& node, std::string_view op, std::string_view function);
+    void visitBitwise(const BinaryAST& node, std::string_view op);
+};
+
+} // namespace evaluate
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Functions.hpp"
+#include "Options.hpp"
+#include "math/Integer.hpp"
+#include "math/VectorMath.hpp"
+#include "util/Error.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <variant>
+
+// the operations of the generated functions on values without a known type, they behave like the
+// Evaluator, except that evaluation errors are reported without their location
+namespace evaluate::aot {
+
+using Value = std::variant<int64_t, double>;
+
+inline double toDouble(Value value) { return getAsDouble(value); }
+inline int64_t integer(Value value) {
+    if (std::holds_alternative<double>(value)) {
+        error("Evaluation Error: invalid usage of bitwise operator on double");
+    }
+    return std::get<int64_t>(value);
+}
+
+inline Value add(Value l, Value r) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return getAsDouble(l) + getAsDouble(r);
+    }
+    return std::get<int64_t>(l) + std::get<int64_t>(r);
+}
+inline Value subtract(Value l, Value r) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return getAsDouble(l) - getAsDouble(r);
+    }
+    return std::get<int64_t>(l) - std::get<int64_t>(r);
+}
+inline Value multiply(Value l, Value r) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return getAsDouble(l) * getAsDouble(r);
+    }
+    return std::get<int64_t>(l) * std::get<int64_t>(r);
+}
+inline Value divide(Value l, Value r) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return getAsDouble(l) / getAsDouble(r);
+    }
+    return std::get<int64_t>(l) / std::get<int64_t>(r);
+}
+// division by a constant whose reciprocal may be multiplied with instead
+inline Value divide(Value l, Value r, double reciprocal) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return getAsDouble(l) * reciprocal;
+    }
+    return std::get<int64_t>(l) / std::get<int64_t>(r);
+}
+inline Value modulo(Value l, Value r) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return std::fmod(getAsDouble(l), getAsDouble(r));
+    }
+    return std::get<int64_t>(l) % std::get<int64_t>(r);
+}
+inline Value negate(Value value) {
+    if (std::holds_alternative<double>(value)) {
+        return -std::get<double>(value);
+    }
+    return -std::get<int64_t>(value);
+}
+inline Value power(int64_t base, int64_t exponent, OverflowPolicy overflow) {
+    int64_t result;
+    if (exponent < 0) {
+        return std::pow(base, exponent);
+    } else if (ipow(base, exponent, result)) {
+        return result;
+    } else if (overflow == OverflowPolicy::error) {
+        error("Evaluation Error: integer overflow in exponentiation");
+    }
+    return std::pow(base, exponent);
+}
+inline Value power(Value base, Value exponent, OverflowPolicy overflow) {
+    if (std::holds_alternative<double>(base) || std::holds_alternative<double>(exponent)) {
+        return std::pow(getAsDouble(base), getAsDouble(exponent));
+    }
+    return power(std::get<int64_t>(base), std::get<int64_t>(exponent), overflow);
+}
+
+// a function with a vectorized kernel for the accuracy
+inline double kernel(FunctionType type, Accuracy accuracy, std::initializer_list<double> values) {
+    std::array<std::span<const double>, 3> params{};
+    for (size_t i = 0; i < values.size(); ++i) {
+        params[i] = std::span(values.begin() + i, 1);
+    }
+    double result;
+    simd::call(type, accuracy, params, std::span(&result, 1));
+    return result;
+}
+inline Value call(FunctionType type, Accuracy accuracy, OverflowPolicy overflow,
+                  std::initializer_list<Value> parameters) {
+    std::array<Value, 3> values{};
+    std::copy(parameters.begin(), parameters.end(), values.begin());
+    std::span arguments(values.data(), parameters.size());
+    if (type == FunctionType::pow && std::holds_alternative<int64_t>(values[0]) &&
+        std::holds_alternative<int64_t>(values[1])) {
+        return power(std::get<int64_t>(values[0]), std::get<int64_t>(values[1]), overflow);
+    } else if (simd::hasKernel(type, accuracy)) {
+        std::array<double, 3> doubles{};
+        std::array<std::span<const double>, 3> params{};
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            doubles[i] = getAsDouble(arguments[i]);
+            params[i] = std::span(&doubles[i], 1);
+        }
+        double result;
+        simd::call(type, accuracy, params, std::span(&result, 1));
+        return result;
+    }
+    return evaluate::call(type, arguments);
+}
+
+} // namespace evaluate::aot
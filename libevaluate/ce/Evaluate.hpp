@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Functions.hpp"
+#include "analyze/AST.hpp"
+#include "ce/Parser.hpp"
+#include "math/Integer.hpp"
+#include "util/Error.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+
+// the evaluation of a parsed expression in a constant evaluation, like the Evaluator with the
+// default Options. undefined behaviour the Evaluator does not check, like an integer overflow, a
+// shift by more than 63 or a division by zero, is a compile error as well
+namespace evaluate::ce {
+
+using Value = std::variant<int64_t, double>;
+
+// base ** exponent of integers like Evaluator::power with OverflowPolicy::promote
+constexpr Value power(int64_t base, int64_t exponent) {
+    int64_t result;
+    if (exponent >= 0 && ipow(base, exponent, result)) {
+        return result;
+    }
+    return std::pow(static_cast<double>(base), static_cast<double>(exponent));
+}
+constexpr Value power(Value base, Value exponent) {
+    if (std::holds_alternative<double>(base) || std::holds_alternative<double>(exponent)) {
+        return std::pow(getAsDouble(base), getAsDouble(exponent));
+    }
+    return power(std::get<int64_t>(base), std::get<int64_t>(exponent));
+}
+
+constexpr int64_t integer(int64_t value) { return value; }
+constexpr int64_t integer(Value value) {
+    if (std::holds_alternative<double>(value)) {
+        error("Evaluation Error: invalid usage of bitwise operator on double");
+    }
+    return std::get<int64_t>(value);
+}
+
+// the operation of a binary node of type on integers, doubles or either
+constexpr int64_t bitwise(AST::Type type, int64_t l, int64_t r) {
+    switch (type) {
+        case AST::Type::OR: return l | r;
+        case AST::Type::XOR: return l ^ r;
+        case AST::Type::AND: return l & r;
+        case AST::Type::SHL: return l << r;
+        default: return l >> r;
+    }
+}
+constexpr int64_t arithmetic(AST::Type type, int64_t l, int64_t r) {
+    switch (type) {
+        case AST::Type::ADD: return l + r;
+        case AST::Type::MINUS: return l - r;
+        case AST::Type::MUL: return l * r;
+        case AST::Type::DIV: return l / r;
+        default: return l % r;
+    }
+}
+constexpr double arithmetic(AST::Type type, double l, double r) {
+    switch (type) {
+        case AST::Type::ADD: return l + r;
+        case AST::Type::MINUS: return l - r;
+        case AST::Type::MUL: return l * r;
+        case AST::Type::DIV: return l / r;
+        default: return std::fmod(l, r);
+    }
+}
+constexpr Value arithmetic(AST::Type type, Value l, Value r) {
+    if (std::holds_alternative<double>(l) || std::holds_alternative<double>(r)) {
+        return arithmetic(type, getAsDouble(l), getAsDouble(r));
+    }
+    return arithmetic(type, std::get<int64_t>(l), std::get<int64_t>(r));
+}
+constexpr Value negate(Value value) {
+    if (std::holds_alternative<double>(value)) {
+        return -std::get<double>(value);
+    }
+    return -std::get<int64_t>(value);
+}
+
+// the value of the node at index, values are the values of the variables
+constexpr Value evaluate(const Program& program, size_t index, std::span<const Value> values) {
+    const Node& node = program.nodes[index];
+    auto child = [&](size_t i) { return evaluate(program, node.children[i], values); };
+    switch (node.type) {
+        case AST::Type::VALUE: return node.fp ? Value(node.floating) : Value(node.integer);
+        case AST::Type::VARIABLE: return values[node.integer];
+        case AST::Type::FUNCTION: {
+            std::array<Value, 3> parameters{};
+            // the Parser rejects more parameters, the check keeps the loop within the array
+            if (node.size > parameters.size()) {
+                error("Syntax Error: too many parameters for " +
+                      std::string(functionName(node.function)));
+            }
+            for (size_t i = 0; i < std::min(node.size, parameters.size()); ++i) {
+                parameters[i] = child(i);
+            }
+            if (node.function == FunctionType::pow &&
+                std::holds_alternative<int64_t>(parameters[0]) &&
+                std::holds_alternative<int64_t>(parameters[1])) {
+                return power(std::get<int64_t>(parameters[0]), std::get<int64_t>(parameters[1]));
+            }
+            return call(node.function, std::span(parameters.data(), node.size));
+        }
+        case AST::Type::POW: return power(child(0), child(1));
+        case AST::Type::OR:
+        case AST::Type::XOR:
+        case AST::Type::AND:
+        case AST::Type::SHL:
+        case AST::Type::SHR: return bitwise(node.type, integer(child(0)), integer(child(1)));
+        case AST::Type::ADD:
+        case AST::Type::MINUS:
+        case AST::Type::MUL:
+        case AST::Type::DIV:
+        case AST::Type::MOD: return arithmetic(node.type, child(0), child(1));
+        case AST::Type::UnaryMINUS: return negate(child(0));
+        case AST::Type::UnaryPLUS: return child(0);
+        case AST::Type::UnaryCOMP: return ~integer(child(0));
+        default: error("unknown error");
+    }
+}
+
+} // namespace evaluate::ce
+
+namespace evaluate {
+
+// the value of an expression without variables, computed at compile time in a constant
+// evaluation: constexpr auto v = evaluate::ce_eval("2 ** 20 * 3"). errors of the expression are
+// compile errors then. the functions of <cmath> are only available with gcc, see Functions.hpp
+constexpr std::variant<int64_t, double> ce_eval(std::string_view expr) {
+    auto program = ce::parse(expr);
+    if (!program.variables.empty()) {
+        error("Semantic Error: unknown variable " + std::string(program.variables.front()));
+    }
+    return ce::evaluate(program, program.root(), {});
+}
+
+namespace ce {
+
+// the value of an expression as a template argument
+template <String code> inline constexpr auto constant = ce_eval(code.view());
+
+} // namespace ce
+
+namespace literals {
+
+// "2 ** 20 * 3"_eval is the value of the expression, computed at compile time,
+// as an int64_t or a double
+template <ce::String code> constexpr auto operator""_eval() {
+    if constexpr (std::holds_alternative<double>(ce::constant<code>)) {
+        return std::get<double>(ce::constant<code>);
+    } else {
+        return std::get<int64_t>(ce::constant<code>);
+    }
+}
+
+} // namespace literals
+
+} // namespace evaluate
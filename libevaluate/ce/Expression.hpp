@@ -0,0 +1,220 @@
+#pragma once
+
+#include "Functions.hpp"
+#include "ValueType.hpp"
+#include "analyze/AST.hpp"
+#include "ce/Evaluate.hpp"
+#include "ce/Parser.hpp"
+#include "util/Error.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// expressions with variables that are parsed at compile time into a type, whose call evaluates
+// every node with an if constexpr chain, so the C++ compiler sees the operations of the expression
+// and nothing else. the value types of the nodes are inferred from the types of the arguments like
+// the Analyzer infers them from the types of the variables, and the operations on them are those
+// of the Evaluator, so the results are the same as with the default Options
+namespace evaluate::ce {
+
+// an argument of a compiled expression: an integer, a double or a value of either type
+template <typename T>
+concept Argument = (std::integral<T> && !std::same_as<T, bool>) || std::floating_point<T> ||
+                   std::same_as<T, Value>;
+
+template <Argument T> constexpr ValueType valueType() {
+    if constexpr (std::same_as<T, Value>) {
+        return ValueType::any;
+    } else if constexpr (std::floating_point<T>) {
+        return ValueType::floating;
+    } else {
+        return ValueType::integer;
+    }
+}
+
+// the C++ type of the values of a value type
+template <ValueType type>
+using Type = std::conditional_t<type == ValueType::integer, int64_t,
+                                std::conditional_t<type == ValueType::floating, double, Value>>;
+
+// value as the C++ type of type, value has this type if it is known
+template <ValueType type, typename T> constexpr Type<type> as(T value) {
+    if constexpr (!std::same_as<T, Value>) {
+        return Type<type>(value);
+    } else if constexpr (type == ValueType::integer) {
+        return std::get<int64_t>(value);
+    } else if constexpr (type == ValueType::floating) {
+        return getAsDouble(value);
+    } else {
+        return value;
+    }
+}
+
+// an expression parsed at compile time, a call with a value for every variable evaluates it.
+// the variables are those given in their order or, without any, the variables of the expression in
+// the order they first appear in
+template <String code, String... variables> class Expression {
+    private:
+    static constexpr size_t size = parse(code.view()).nodes.size();
+    static constexpr size_t used = parse(code.view()).variables.size();
+
+    public:
+    static constexpr size_t arity = sizeof...(variables) == 0 ? used : sizeof...(variables);
+
+    private:
+    static constexpr std::array<Node, size> nodes = [] {
+        auto program = parse(code.view());
+        std::array<Node, size> nodes{};
+        std::copy(program.nodes.begin(), program.nodes.end(), nodes.begin());
+        return nodes;
+    }();
+    // the parameter of every variable of the expression
+    static constexpr std::array<size_t, used> parameters = [] {
+        auto program = parse(code.view());
+        std::array<std::string_view, sizeof...(variables)> names{variables.view()...};
+        std::array<size_t, used> parameters{};
+        for (size_t i = 0; i < used; ++i) {
+            if (names.empty()) {
+                parameters[i] = i;
+                continue;
+            }
+            auto name = std::find(names.begin(), names.end(), program.variables[i]);
+            if (name == names.end()) {
+                error("Semantic Error: unknown variable " + std::string(program.variables[i]));
+            }
+            parameters[i] = name - names.begin();
+        }
+        return parameters;
+    }();
+
+    public:
+    template <Argument... Args>
+    requires(sizeof...(Args) == arity) constexpr auto operator()(Args... args) const {
+        constexpr auto types = inferValueTypes({valueType<Args>()...});
+        std::tuple values{as<valueType<Args>()>(args)...};
+        return evaluate<types, size - 1>(values);
+    }
+
+    private:
+    // the value types of all nodes for the value types of the parameters
+    static constexpr std::array<ValueType, size>
+    inferValueTypes(std::array<ValueType, arity> parameterTypes) {
+        std::array<ValueType, size> types{};
+        for (size_t i = 0; i < size; ++i) {
+            const Node& node = nodes[i];
+            if (node.type == AST::Type::VALUE) {
+                types[i] = node.fp ? ValueType::floating : ValueType::integer;
+            } else if (node.type == AST::Type::VARIABLE) {
+                types[i] = parameterTypes[parameters[node.integer]];
+            } else {
+                std::array<ValueType, 3> operands{};
+                for (size_t c = 0; c < node.size; ++c) {
+                    operands[c] = types[node.children[c]];
+                }
+                types[i] = inferValueType(node.type, node.function,
+                                          std::span(operands.data(), node.size));
+            }
+        }
+        return types;
+    }
+
+    // the value of the child c of the node at index
+    template <auto types, size_t index, size_t c, typename Values>
+    static constexpr auto operand(const Values& values) {
+        return evaluate<types, nodes[index].children[c]>(values);
+    }
+
+    template <auto types, size_t index, typename Values>
+    static constexpr Type<types[index]> evaluate(const Values& values) {
+        constexpr Node node = nodes[index];
+        constexpr ValueType type = types[index];
+        if constexpr (node.type == AST::Type::VALUE) {
+            if constexpr (node.fp) {
+                return node.floating;
+            } else {
+                return node.integer;
+            }
+        } else if constexpr (node.type == AST::Type::VARIABLE) {
+            return std::get<parameters[node.integer]>(values);
+        } else if constexpr (node.type == AST::Type::FUNCTION) {
+            return function<types, index>(values, std::make_index_sequence<node.size>());
+        } else if constexpr (node.type == AST::Type::POW) {
+            auto l = operand<types, index, 0>(values);
+            auto r = operand<types, index, 1>(values);
+            if constexpr (type == ValueType::floating) {
+                return std::pow(as<ValueType::floating>(l), as<ValueType::floating>(r));
+            } else {
+                return power(l, r);
+            }
+        } else if constexpr (node.type == AST::Type::OR || node.type == AST::Type::XOR ||
+                             node.type == AST::Type::AND || node.type == AST::Type::SHL ||
+                             node.type == AST::Type::SHR) {
+            static_assert(types[node.children[0]] != ValueType::floating &&
+                              types[node.children[1]] != ValueType::floating,
+                          "Semantic Error: invalid usage of bitwise operator on double");
+            auto l = operand<types, index, 0>(values);
+            return bitwise(node.type, integer(l), integer(operand<types, index, 1>(values)));
+        } else if constexpr (node.type == AST::Type::UnaryMINUS) {
+            auto v = operand<types, index, 0>(values);
+            if constexpr (type == ValueType::any) {
+                return negate(v);
+            } else {
+                return -v;
+            }
+        } else if constexpr (node.type == AST::Type::UnaryPLUS) {
+            return operand<types, index, 0>(values);
+        } else if constexpr (node.type == AST::Type::UnaryCOMP) {
+            static_assert(types[node.children[0]] != ValueType::floating,
+                          "Semantic Error: invalid usage of bitwise operator on double");
+            return ~integer(operand<types, index, 0>(values));
+        } else {
+            auto l = operand<types, index, 0>(values);
+            auto r = operand<types, index, 1>(values);
+            if constexpr (type == ValueType::any) {
+                return arithmetic(node.type, Value(l), Value(r));
+            } else {
+                return arithmetic(node.type, as<type>(l), as<type>(r));
+            }
+        }
+    }
+
+    template <auto types, size_t index, typename Values, size_t... c>
+    static constexpr Type<types[index]> function(const Values& values, std::index_sequence<c...>) {
+        constexpr Node node = nodes[index];
+        static_assert(!isIntegerFunction(node.function) ||
+                          ((types[node.children[c]] != ValueType::floating) && ...),
+                      "Semantic Error: integer function called with a floating point argument");
+        std::array<Value, sizeof...(c)> arguments{Value(operand<types, index, c>(values))...};
+        if constexpr (node.function == FunctionType::pow) {
+            if (std::holds_alternative<int64_t>(arguments[0]) &&
+                std::holds_alternative<int64_t>(arguments[1])) {
+                return as<types[index]>(
+                    power(std::get<int64_t>(arguments[0]), std::get<int64_t>(arguments[1])));
+            }
+        }
+        return as<types[index]>(functionCall<node.function>(arguments[c]...));
+    }
+};
+
+} // namespace evaluate::ce
+
+namespace evaluate {
+
+// the expression compiled at compile time into a callable with a parameter for every variable,
+// e.g. compile<"a * x + sin(b)">()(a, x, b) or compile<"a * x + sin(b)", "x", "a", "b">()(x, a, b).
+// parameters are integers, doubles or std::variant<int64_t, double>, the result is int64_t, double
+// or std::variant<int64_t, double> as the value type of the expression for these types
+template <ce::String code, ce::String... variables> constexpr auto compile() {
+    return ce::Expression<code, variables...>();
+}
+
+} // namespace evaluate
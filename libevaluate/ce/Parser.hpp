@@ -0,0 +1,431 @@
+#pragma once
+
+#include "Functions.hpp"
+#include "analyze/AST.hpp"
+#include "lex/Token.hpp"
+#include "util/Error.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// the lexer and parser of an expression in a constant evaluation, where the call of error() is a
+// compile error. they follow the grammar of Lexer and Parser: ** binds loosest and every binary
+// operator is right associative, so a - b - c is a - (b - c). unlike them tokens after the
+// expression, a missing right bracket, a literal with two points and a call with the wrong number
+// of parameters are syntax errors instead of being ignored
+namespace evaluate::ce {
+
+// a string literal as a template argument
+template <size_t N> struct String {
+    char data[N]{};
+
+    constexpr String(const char (&code)[N]) { std::copy_n(code, N, data); }
+    constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+// a node of the parsed expression, named like the AST node it becomes in Analyzer
+struct Node {
+    AST::Type type = AST::Type::VALUE;
+    bool fp = false;         // whether a VALUE is a double
+    int64_t integer = 0;     // the value of an integer VALUE, the index of a VARIABLE
+    double floating = 0;     // the value of a double VALUE
+    FunctionType function{}; // of a FUNCTION
+    size_t size = 0;         // the number of children
+    std::array<size_t, 3> children{};
+};
+
+// the nodes of an expression, children come before their parent, so the root is the last node.
+// the variables are numbered in the order they first appear in
+struct Program {
+    std::vector<Node> nodes;
+    std::vector<std::string_view> variables;
+
+    constexpr size_t root() const { return nodes.size() - 1; }
+};
+
+// an unsigned integer of any size, for the exactly rounded conversion of a literal to a double
+class Natural {
+    private:
+    std::vector<uint32_t> limbs; // least significant first, without leading zeros
+
+    public:
+    constexpr explicit Natural(uint64_t value) {
+        for (; value != 0; value >>= 32) {
+            limbs.push_back(static_cast<uint32_t>(value));
+        }
+    }
+
+    constexpr bool isZero() const { return limbs.empty(); }
+    constexpr int64_t bits() const {
+        return limbs.empty() ? 0 : limbs.size() * 32 - std::countl_zero(limbs.back());
+    }
+
+    // this * factor + summand
+    constexpr void multiplyAdd(uint32_t factor, uint32_t summand) {
+        uint64_t carry = summand;
+        for (auto& limb : limbs) {
+            uint64_t product = uint64_t(limb) * factor + carry;
+            limb = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        if (carry != 0) {
+            limbs.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+    constexpr void shiftLeft(int64_t n) {
+        if (isZero()) {
+            return;
+        }
+        limbs.insert(limbs.begin(), n / 32, 0);
+        if (n % 32 != 0) {
+            uint32_t carry = 0;
+            for (auto& limb : limbs) {
+                uint32_t next = limb >> (32 - n % 32);
+                limb = limb << (n % 32) | carry;
+                carry = next;
+            }
+            if (carry != 0) {
+                limbs.push_back(carry);
+            }
+        }
+    }
+    // requires *this >= other
+    constexpr void subtract(const Natural& other) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            int64_t difference = int64_t(limbs[i]) - borrow;
+            if (i < other.limbs.size()) {
+                difference -= other.limbs[i];
+            }
+            borrow = difference < 0;
+            limbs[i] = static_cast<uint32_t>(difference + (borrow << 32));
+        }
+        while (!limbs.empty() && limbs.back() == 0) {
+            limbs.pop_back();
+        }
+    }
+    constexpr bool operator>=(const Natural& other) const {
+        if (limbs.size() != other.limbs.size()) {
+            return limbs.size() > other.limbs.size();
+        }
+        return !std::lexicographical_compare(limbs.rbegin(), limbs.rend(), other.limbs.rbegin(),
+                                             other.limbs.rend());
+    }
+};
+
+// the double nearest to digits / 10 ** decimals, rounded half to even like strtod
+constexpr double toDouble(std::string_view digits, size_t decimals) {
+    Natural numerator(0);
+    Natural denominator(1);
+    for (char c : digits) {
+        numerator.multiplyAdd(10, c - '0');
+    }
+    for (size_t i = 0; i < decimals; ++i) {
+        denominator.multiplyAdd(10, 0);
+    }
+    if (numerator.isZero()) {
+        return 0.0;
+    }
+    // both are exact and the division rounds once
+    if (numerator.bits() <= 53 && decimals <= 22) {
+        double n = 0, d = 1;
+        for (char c : digits) {
+            n = n * 10 + (c - '0');
+        }
+        for (size_t i = 0; i < decimals; ++i) {
+            d *= 10;
+        }
+        return n / d;
+    }
+    // the quotient with 55 or 56 bits by long division, where shifting the numerator left instead
+    // of the denominator right keeps the remainder, which decides the rounding of the rest
+    int64_t shift = 55 - (numerator.bits() - denominator.bits());
+    if (shift > 0) {
+        numerator.shiftLeft(shift);
+    } else {
+        denominator.shiftLeft(-shift);
+    }
+    denominator.shiftLeft(56);
+    uint64_t quotient = 0;
+    for (int bit = 56; bit >= 0; --bit) {
+        if (numerator >= denominator) {
+            numerator.subtract(denominator);
+            quotient |= uint64_t(1) << bit;
+        }
+        numerator.shiftLeft(1);
+    }
+    int drop = std::bit_width(quotient) - 53;
+    bool round = quotient >> (drop - 1) & 1;
+    bool sticky = !numerator.isZero() || (quotient & ((uint64_t(1) << (drop - 1)) - 1)) != 0;
+    uint64_t mantissa = quotient >> drop;
+    int64_t exponent = drop - shift;
+    if (round && (sticky || (mantissa & 1))) {
+        ++mantissa;
+    }
+    if (mantissa >> 53) {
+        mantissa >>= 1;
+        ++exponent;
+    }
+    int64_t biased = exponent + 52 + 1023;
+    if (biased <= 0 || biased >= 2047) {
+        error("Syntax Error: floating point value out of range");
+    }
+    return std::bit_cast<double>(uint64_t(biased) << 52 | (mantissa & ((uint64_t(1) << 52) - 1)));
+}
+
+class Parser {
+    private:
+    struct Token {
+        evaluate::Token::Type type;
+        std::string_view code;
+    };
+
+    std::string_view code;
+    size_t offset = 0;
+    std::optional<Token> reg;
+    Program program;
+
+    public:
+    constexpr explicit Parser(std::string_view code) : code(code) {}
+
+    constexpr Program parse() && {
+        parseOptionalList(0);
+        if (hasNext()) {
+            error("Syntax Error: unexpected Token after the expression: " +
+                  std::string(next().code));
+        }
+        return std::move(program);
+    }
+
+    private:
+    static constexpr bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+    static constexpr bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    static constexpr bool isAlpha(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+    static constexpr bool isFunction(char c) { return isAlpha(c) || isDigit(c) || c == '_'; }
+
+    constexpr bool hasNext() {
+        while (offset < code.size() && isSpace(code[offset])) {
+            ++offset;
+        }
+        return reg.has_value() || offset < code.size();
+    }
+    constexpr Token next() {
+        using enum evaluate::Token::Type;
+        if (reg.has_value()) {
+            Token token = *reg;
+            reg.reset();
+            return token;
+        }
+        if (!hasNext()) {
+            error("Syntax Error: no more tokens");
+        }
+        size_t start = offset;
+        char c = code[offset++];
+        if (isDigit(c) || c == '.') {
+            while (offset < code.size() && (isDigit(code[offset]) || code[offset] == '.')) {
+                ++offset;
+            }
+            return {NUMBER, code.substr(start, offset - start)};
+        } else if (isAlpha(c)) {
+            while (offset < code.size() && isFunction(code[offset])) {
+                ++offset;
+            }
+            size_t end = offset;
+            while (end < code.size() && isSpace(code[end])) {
+                ++end;
+            }
+            bool function = end < code.size() && code[end] == '(';
+            return {function ? FUNCTION : VARIABLE, code.substr(start, offset - start)};
+        }
+        auto token = [&](evaluate::Token::Type type) {
+            return Token{type, code.substr(start, offset - start)};
+        };
+        switch (c) {
+            case ',': return token(COMMA);
+            case '+': return token(PLUS);
+            case '-': return token(MINUS);
+            case '/': return token(DIV);
+            case '%': return token(MOD);
+            case '&': return token(AND);
+            case '|': return token(OR);
+            case '~': return token(COMP);
+            case '^': return token(XOR);
+            case '(': return token(LEFT_BRACKET);
+            case ')': return token(RIGHT_BRACKET);
+            case '*': {
+                if (offset < code.size() && code[offset] == '*') {
+                    ++offset;
+                    return token(POWER);
+                }
+                return token(MUL);
+            }
+            case '<': {
+                if (offset < code.size() && code[offset] == '<') {
+                    ++offset;
+                    return token(SHL);
+                }
+                error("unexpected character, should be: <<");
+            }
+            case '>': {
+                if (offset < code.size() && code[offset] == '>') {
+                    ++offset;
+                    return token(SHR);
+                }
+                error("unexpected character, should be: >>");
+            }
+            default: error("unknown character");
+        }
+    }
+    constexpr Token expect(evaluate::Token::Type type, std::string_view name) {
+        Token token = next();
+        if (token.type != type) {
+            error("Syntax Error: unexpected Token, should be: " + std::string(name));
+        }
+        return token;
+    }
+
+    constexpr size_t add(Node node) {
+        program.nodes.push_back(node);
+        return program.nodes.size() - 1;
+    }
+
+    // the node of a binary operator and the level of the grammar it is parsed at, from ** at 0,
+    // which binds loosest, to * / % at 6. unary operators are parsed at level 7
+    static constexpr std::optional<std::pair<int, AST::Type>> binary(evaluate::Token::Type type) {
+        switch (type) {
+            case evaluate::Token::Type::POWER: return std::pair{0, AST::Type::POW};
+            case evaluate::Token::Type::OR: return std::pair{1, AST::Type::OR};
+            case evaluate::Token::Type::XOR: return std::pair{2, AST::Type::XOR};
+            case evaluate::Token::Type::AND: return std::pair{3, AST::Type::AND};
+            case evaluate::Token::Type::SHL: return std::pair{4, AST::Type::SHL};
+            case evaluate::Token::Type::SHR: return std::pair{4, AST::Type::SHR};
+            case evaluate::Token::Type::PLUS: return std::pair{5, AST::Type::ADD};
+            case evaluate::Token::Type::MINUS: return std::pair{5, AST::Type::MINUS};
+            case evaluate::Token::Type::MUL: return std::pair{6, AST::Type::MUL};
+            case evaluate::Token::Type::DIV: return std::pair{6, AST::Type::DIV};
+            case evaluate::Token::Type::MOD: return std::pair{6, AST::Type::MOD};
+            default: return std::nullopt;
+        }
+    }
+
+    constexpr size_t parseOptionalList(int level) {
+        if (level == 7) {
+            return parseUnary();
+        }
+        size_t l = parseOptionalList(level + 1);
+        if (hasNext()) {
+            Token token = next();
+            auto operation = binary(token.type);
+            if (operation && operation->first == level) {
+                size_t r = parseOptionalList(level);
+                return add({.type = operation->second, .size = 2, .children = {l, r}});
+            }
+            reg.emplace(token);
+        }
+        return l;
+    }
+
+    constexpr size_t parseUnary() {
+        Token token = next();
+        switch (token.type) {
+            case evaluate::Token::Type::PLUS:
+                return add({.type = AST::Type::UnaryPLUS, .size = 1, .children = {parseUnary()}});
+            case evaluate::Token::Type::MINUS:
+                return add({.type = AST::Type::UnaryMINUS, .size = 1, .children = {parseUnary()}});
+            case evaluate::Token::Type::COMP:
+                return add({.type = AST::Type::UnaryCOMP, .size = 1, .children = {parseUnary()}});
+            default: reg.emplace(token); return parsePrimary();
+        }
+    }
+
+    constexpr size_t parsePrimary() {
+        Token token = next();
+        switch (token.type) {
+            case evaluate::Token::Type::NUMBER: return parseLiteral(token.code);
+            case evaluate::Token::Type::LEFT_BRACKET: {
+                size_t pow = parseOptionalList(0);
+                expect(evaluate::Token::Type::RIGHT_BRACKET, "right bracket");
+                return pow;
+            }
+            case evaluate::Token::Type::FUNCTION: return parseFunction(token.code);
+            case evaluate::Token::Type::VARIABLE: {
+                auto& variables = program.variables;
+                auto variable = std::find(variables.begin(), variables.end(), token.code);
+                int64_t index = variable - variables.begin();
+                if (variable == variables.end()) {
+                    variables.push_back(token.code);
+                }
+                return add({.type = AST::Type::VARIABLE, .integer = index});
+            }
+            default: error("Syntax Error: unexpected Token, should be: primary expression");
+        }
+    }
+
+    constexpr size_t parseLiteral(std::string_view literal) {
+        // no string_view::find or std::string(string_view), gcc rejects both in constant
+        // expressions with -fsanitize=undefined
+        auto point = static_cast<size_t>(std::ranges::find(literal, '.') - literal.begin());
+        if (point == literal.size()) {
+            int64_t value = 0;
+            for (char c : literal) {
+                if (__builtin_mul_overflow(value, 10, &value) ||
+                    __builtin_add_overflow(value, c - '0', &value)) {
+                    error("Syntax Error: value out of range");
+                }
+            }
+            return add({.integer = value});
+        }
+        std::string digits;
+        for (char c : literal) {
+            if (c != '.') {
+                digits += c;
+            }
+        }
+        if (digits.empty() || digits.size() + 1 != literal.size()) {
+            error("Syntax Error: invalid literal");
+        }
+        return add({.fp = true, .floating = toDouble(digits, literal.size() - point - 1)});
+    }
+
+    constexpr size_t parseFunction(std::string_view name) {
+        auto type = functionType(name);
+        if (!type) {
+            error("Semantic Error: unknown function name " + std::string(name));
+        }
+        expect(evaluate::Token::Type::LEFT_BRACKET, "left bracket");
+        Node node{.type = AST::Type::FUNCTION, .function = *type};
+        Token token = next();
+        if (token.type != evaluate::Token::Type::RIGHT_BRACKET) {
+            reg.emplace(token);
+            do {
+                if (node.size == node.children.size()) {
+                    error("Syntax Error: too many parameters for " + std::string(name));
+                }
+                node.children[node.size++] = parseOptionalList(0);
+                token = next();
+            } while (token.type == evaluate::Token::Type::COMMA);
+            if (token.type != evaluate::Token::Type::RIGHT_BRACKET) {
+                error("Syntax Error: unexpected Token, should be: right bracket");
+            }
+        }
+        if (static_cast<int>(node.size) != functionParams(*type)) {
+            error("Syntax Error: wrong number of parameters for " + std::string(name));
+        }
+        return add(node);
+    }
+};
+
+constexpr Program parse(std::string_view code) { return Parser(code).parse(); }
+
+} // namespace evaluate::ce
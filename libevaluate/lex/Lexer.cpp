@@ -31,7 +31,15 @@ namespace evaluate {
             } else if (isalpha(c)) { // start with a alphabet
                 size_t start = offset;
                 while (offset < size && isFunction(code.charAt(++offset)));
-                return {Token::Type::FUNCTION, code.ref(start, offset)};
+                size_t end = offset;
+                while (end < size && isspace(code.charAt(end))) {
+                    ++end;
+                }
+                if (end < size && code.charAt(end) == '(') {
+                    return {Token::Type::FUNCTION, code.ref(start, offset)};
+                } else {
+                    return {Token::Type::VARIABLE, code.ref(start, offset)};
+                }
             } else {
                 ++offset;
                 switch (c) {
@@ -10,6 +10,7 @@ namespace evaluate {
             COMMA,          /* ","  */
             NUMBER,         /* "12" */
             FUNCTION,       /* fun  */
+            VARIABLE,       /* var  */
             // arithmetics
             PLUS,           /* "+"  */
             MINUS,          /* "-"  */
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+
+namespace evaluate {
+
+// base ** exponent by square and multiply, returns false if the result overflows
+constexpr bool ipow(int64_t base, uint64_t exponent, int64_t& result) {
+    bool overflow = false;
+    result = 1;
+    while (true) {
+        if (exponent & 1) {
+            overflow |= __builtin_mul_overflow(result, base, &result);
+        }
+        exponent >>= 1;
+        if (exponent == 0) {
+            return !overflow;
+        }
+        // every square computed here is part of the result, so its overflow is the result's
+        overflow |= __builtin_mul_overflow(base, base, &base);
+    }
+}
+
+// the same for a known exponent, unrolled into a chain of multiplications
+template <uint64_t exponent> constexpr bool ipow(int64_t base, int64_t& result) {
+    if constexpr (exponent == 0) {
+        result = 1;
+        return true;
+    } else if constexpr (exponent == 1) {
+        result = base;
+        return true;
+    } else {
+        int64_t half;
+        bool exact = ipow<exponent / 2>(base, half);
+        exact &= !__builtin_mul_overflow(half, half, &result);
+        if constexpr (exponent % 2 == 1) {
+            exact &= !__builtin_mul_overflow(result, base, &result);
+        }
+        return exact;
+    }
+}
+
+using IntegerPower = bool (*)(int64_t base, int64_t& result);
+
+template <size_t... exponents>
+constexpr std::array<IntegerPower, sizeof...(exponents)>
+integerPowers(std::index_sequence<exponents...>) {
+    return {&ipow<exponents>...};
+}
+
+// the unrolled power for a constant exponent, nullptr if there is none.
+// any base other than 0, 1 and -1 overflows at exponent 63, so larger exponents are not unrolled
+inline IntegerPower integerPower(int64_t exponent) {
+    static constexpr auto powers = integerPowers(std::make_index_sequence<64>());
+    if (exponent < 0 || static_cast<size_t>(exponent) >= powers.size()) {
+        return nullptr;
+    }
+    return powers[exponent];
+}
+
+// truncating division by a constant as a multiplication with a magic number and a shift,
+// computed as in Hacker's Delight 10-1. the divisor must not be 0, 1 or -1
+class SignedDivisor {
+    private:
+    int64_t divisor;
+    int64_t magic;
+    int shift;
+
+    public:
+    constexpr explicit SignedDivisor(int64_t divisor) : divisor(divisor), magic(0), shift(0) {
+        constexpr uint64_t two63 = uint64_t(1) << 63;
+        const uint64_t ad = divisor < 0 ? 0 - static_cast<uint64_t>(divisor) : divisor;
+        const uint64_t t = two63 + (static_cast<uint64_t>(divisor) >> 63);
+        const uint64_t anc = t - 1 - t % ad;
+        int p = 63;
+        uint64_t q1 = two63 / anc, r1 = two63 - q1 * anc;
+        uint64_t q2 = two63 / ad, r2 = two63 - q2 * ad;
+        uint64_t delta;
+        do {
+            ++p;
+            q1 *= 2;
+            r1 *= 2;
+            if (r1 >= anc) {
+                ++q1;
+                r1 -= anc;
+            }
+            q2 *= 2;
+            r2 *= 2;
+            if (r2 >= ad) {
+                ++q2;
+                r2 -= ad;
+            }
+            delta = ad - r2;
+        } while (q1 < delta || (q1 == delta && r1 == 0));
+        magic = static_cast<int64_t>(divisor < 0 ? 0 - (q2 + 1) : q2 + 1);
+        shift = p - 64;
+    }
+
+    constexpr int64_t divide(int64_t n) const {
+        int64_t q = static_cast<int64_t>((__extension__ static_cast<__int128>(magic) * n) >> 64);
+        if (divisor > 0 && magic < 0) {
+            q += n;
+        } else if (divisor < 0 && magic > 0) {
+            q -= n;
+        }
+        q >>= shift;
+        return q + static_cast<int64_t>(static_cast<uint64_t>(q) >> 63);
+    }
+    constexpr int64_t modulo(int64_t n) const { return n - divide(n) * divisor; }
+    constexpr int64_t getDivisor() const { return divisor; }
+};
+
+// bit manipulation on the two's complement representation
+constexpr int64_t popcount(int64_t x) { return std::popcount(static_cast<uint64_t>(x)); }
+constexpr int64_t clz(int64_t x) { return std::countl_zero(static_cast<uint64_t>(x)); }
+constexpr int64_t ctz(int64_t x) { return std::countr_zero(static_cast<uint64_t>(x)); }
+constexpr int64_t rotl(int64_t x, int64_t n) {
+    return static_cast<int64_t>(std::rotl(static_cast<uint64_t>(x), static_cast<int>(n % 64)));
+}
+constexpr int64_t rotr(int64_t x, int64_t n) {
+    return static_cast<int64_t>(std::rotr(static_cast<uint64_t>(x), static_cast<int>(n % 64)));
+}
+constexpr int64_t bswap(int64_t x) {
+    return static_cast<int64_t>(__builtin_bswap64(static_cast<uint64_t>(x)));
+}
+// length bits of x starting at bit start, bits past the top are zero
+constexpr int64_t bextract(int64_t x, int64_t start, int64_t length) {
+    if (start < 0 || length <= 0 || start >= 64) {
+        return 0;
+    }
+    uint64_t bits = static_cast<uint64_t>(x) >> start;
+    return static_cast<int64_t>(length >= 64 ? bits : bits & ((uint64_t(1) << length) - 1));
+}
+// gcd of the absolute values, gcd(INT64_MIN, 0) wraps around to INT64_MIN
+constexpr int64_t gcd(int64_t a, int64_t b) {
+    auto magnitude = [](int64_t x) { return x < 0 ? 0 - static_cast<uint64_t>(x) : x; };
+    return static_cast<int64_t>(std::gcd(magnitude(a), magnitude(b)));
+}
+// base ** exponent % modulus in [0, modulus), requires exponent >= 0 and modulus > 0
+constexpr int64_t modpow(int64_t base, int64_t exponent, int64_t modulus) {
+    __extension__ using uint128 = unsigned __int128;
+    const uint64_t m = modulus;
+    uint64_t b = static_cast<uint64_t>(base % modulus + (base % modulus < 0 ? modulus : 0));
+    uint64_t result = 1 % m;
+    for (auto e = static_cast<uint64_t>(exponent); e != 0; e >>= 1) {
+        if (e & 1) {
+            result = static_cast<uint64_t>(static_cast<uint128>(result) * b % m);
+        }
+        b = static_cast<uint64_t>(static_cast<uint128>(b) * b % m);
+    }
+    return static_cast<int64_t>(result);
+}
+
+} // namespace evaluate
@@ -0,0 +1,728 @@
+#include "VectorMath.hpp"
+#include "math/Integer.hpp"
+
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace evaluate::simd {
+
+namespace {
+
+#ifdef __AVX__
+constexpr size_t vectorSize = 32;
+#else
+constexpr size_t vectorSize = 16;
+#endif
+using vdouble = double __attribute__((vector_size(vectorSize)));
+using vint = int64_t __attribute__((vector_size(vectorSize)));
+constexpr size_t lanes = sizeof(vdouble) / sizeof(double);
+
+constexpr double shifter = 0x1.8p52;
+
+inline vdouble splat(double value) { return vdouble{} + value; }
+inline vint splat(int64_t value) { return vint{} + value; }
+inline vdouble select(vint mask, vdouble a, vdouble b) {
+    return (vdouble) ((mask & (vint) a) | (~mask & (vint) b));
+}
+inline vdouble abs(vdouble x) { return (vdouble) ((vint) x & INT64_MAX); }
+inline vdouble copysign(vdouble x, vdouble sign) {
+    return (vdouble) (((vint) x & INT64_MAX) | ((vint) sign & INT64_MIN));
+}
+inline vdouble toDouble(vint x) { return __builtin_convertvector(x, vdouble); }
+inline bool any(vint mask) {
+    for (size_t i = 0; i < lanes; ++i) {
+        if (mask[i]) return true;
+    }
+    return false;
+}
+// round to nearest, valid for |x| < 2^51
+inline vdouble roundToInt(vdouble x, vint& n) {
+    vdouble shifted = x + shifter;
+    n = (vint) shifted - (vint) splat(shifter);
+    return shifted - shifter;
+}
+// 2^n for n in [-1022, 1023]
+inline vdouble exp2i(vint n) { return (vdouble) ((n + 1023) << 52); }
+
+struct dd {
+    vdouble hi;
+    vdouble lo;
+};
+inline dd twoSum(vdouble a, vdouble b) {
+    vdouble s = a + b;
+    vdouble bb = s - a;
+    return {s, (a - (s - bb)) + (b - bb)};
+}
+inline dd fastTwoSum(vdouble a, vdouble b) {
+    vdouble s = a + b;
+    return {s, b - (s - a)};
+}
+inline dd split(vdouble a) {
+    vdouble t = a * 134217729.0;
+    vdouble hi = t - (t - a);
+    return {hi, a - hi};
+}
+inline dd twoProduct(vdouble a, vdouble b) {
+    vdouble p = a * b;
+    dd x = split(a);
+    dd y = split(b);
+    return {p, ((x.hi * y.hi - p) + x.hi * y.lo + x.lo * y.hi) + x.lo * y.lo};
+}
+
+template <size_t N> inline vdouble horner(vdouble x, const double (&c)[N]) {
+    vdouble r = splat(c[N - 1]);
+    for (size_t i = N - 1; i-- > 0;) r = r * x + c[i];
+    return r;
+}
+
+// 2^(j/32) as double-double
+constexpr double exp2Table[32][2] = {
+    {0x1.0000000000000p+0, 0x0.0p+0},
+    {0x1.059b0d3158574p+0, 0x1.d73e2a475b465p-55},
+    {0x1.0b5586cf9890fp+0, 0x1.8a62e4adc610bp-54},
+    {0x1.11301d0125b51p+0, -0x1.6c51039449b3ap-54},
+    {0x1.172b83c7d517bp+0, -0x1.19041b9d78a76p-55},
+    {0x1.1d4873168b9aap+0, 0x1.e016e00a2643cp-54},
+    {0x1.2387a6e756238p+0, 0x1.9b07eb6c70573p-54},
+    {0x1.29e9df51fdee1p+0, 0x1.612e8afad1255p-55},
+    {0x1.306fe0a31b715p+0, 0x1.6f46ad23182e4p-55},
+    {0x1.371a7373aa9cbp+0, -0x1.63aeabf42eae2p-54},
+    {0x1.3dea64c123422p+0, 0x1.ada0911f09ebcp-55},
+    {0x1.44e086061892dp+0, 0x1.89b7a04ef80d0p-59},
+    {0x1.4bfdad5362a27p+0, 0x1.d4397afec42e2p-56},
+    {0x1.5342b569d4f82p+0, -0x1.07abe1db13cadp-55},
+    {0x1.5ab07dd485429p+0, 0x1.6324c054647adp-54},
+    {0x1.6247eb03a5585p+0, -0x1.383c17e40b497p-54},
+    {0x1.6a09e667f3bcdp+0, -0x1.bdd3413b26456p-54},
+    {0x1.71f75e8ec5f74p+0, -0x1.16e4786887a99p-55},
+    {0x1.7a11473eb0187p+0, -0x1.41577ee04992fp-55},
+    {0x1.82589994cce13p+0, -0x1.d4c1dd41532d8p-54},
+    {0x1.8ace5422aa0dbp+0, 0x1.6e9f156864b27p-54},
+    {0x1.93737b0cdc5e5p+0, -0x1.75fc781b57ebcp-57},
+    {0x1.9c49182a3f090p+0, 0x1.c7c46b071f2bep-56},
+    {0x1.a5503b23e255dp+0, -0x1.d2f6edb8d41e1p-54},
+    {0x1.ae89f995ad3adp+0, 0x1.7a1cd345dcc81p-54},
+    {0x1.b7f76f2fb5e47p+0, -0x1.5584f7e54ac3bp-56},
+    {0x1.c199bdd85529cp+0, 0x1.11065895048ddp-55},
+    {0x1.cb720dcef9069p+0, 0x1.503cbd1e949dbp-56},
+    {0x1.d5818dcfba487p+0, 0x1.2ed02d75b3707p-55},
+    {0x1.dfc97337b9b5fp+0, -0x1.1a5cd4f184b5cp-54},
+    {0x1.ea4afa2a490dap+0, -0x1.e9c23179c2893p-54},
+    {0x1.f50765b6e4540p+0, 0x1.9d3e12dd8a18bp-54},
+};
+constexpr double invLn2x32 = 0x1.71547652b82fep+5;
+constexpr double ln2x32Hi = 0x1.62e42fee00000p-6;
+constexpr double ln2x32Lo = 0x1.a39ef35793c76p-38;
+// exp(r) - 1 on |r| <= ln2 / 64
+constexpr double expm1Poly[] = {0x1p0,
+                                0x1p-1,
+                                0x1.5555555555555p-3,
+                                0x1.5555555555555p-5,
+                                0x1.1111111111111p-7,
+                                0x1.6c16c16c16c17p-10};
+// (exp(x) - 1 - x) / x^2 on |x| <= ln2 / 2
+constexpr double expm1Taylor[] = {
+    0x1p-1,               0x1.5555555555555p-3, 0x1.5555555555555p-5, 0x1.1111111111111p-7,
+    0x1.6c16c16c16c17p-10, 0x1.a01a01a01a01ap-13, 0x1.a01a01a01a01ap-16, 0x1.71de3a556c734p-19,
+    0x1.27e4fb7789f5cp-22, 0x1.ae64567f544e4p-26, 0x1.1eed8eff8d898p-29, 0x1.6124613a86d09p-33,
+    0x1.93974a8c07c9dp-37};
+
+// x = (32 k + j) ln2 / 32 + r: returns 2^(j/32) (1 + expm1(r)) split as (table, table * expm1(r))
+struct expReduction {
+    vint k;
+    dd table;
+    vdouble tail;
+};
+inline expReduction reduceExp(vint n, vdouble r) {
+    expReduction result;
+    result.k = n >> 5;
+    vint j = n & 31;
+    for (size_t i = 0; i < lanes; ++i) {
+        result.table.hi[i] = exp2Table[j[i]][0];
+        result.table.lo[i] = exp2Table[j[i]][1];
+    }
+    vdouble p = r * horner(r, expm1Poly);
+    result.tail = result.table.lo + result.table.hi * p;
+    return result;
+}
+// exp(hi + lo) for |hi| <= 707
+inline vdouble expCore(vdouble hi, vdouble lo) {
+    vint n;
+    vdouble nd = roundToInt(hi * invLn2x32, n);
+    vdouble r = (hi - nd * ln2x32Hi) + (lo - nd * ln2x32Lo);
+    expReduction e = reduceExp(n, r);
+    return (e.table.hi + e.tail) * exp2i(e.k);
+}
+
+vdouble exp(vdouble x, vint& special) {
+    special = ~(abs(x) <= 707.0);
+    return expCore(x, splat(0.0));
+}
+vdouble exp2(vdouble x, vint& special) {
+    special = ~(abs(x) <= 1020.0);
+    vint n;
+    vdouble nd = roundToInt(x * 32.0, n);
+    vdouble r = (x - nd * 0x1p-5) * 0x1.62e42fefa39efp-1;
+    expReduction e = reduceExp(n, r);
+    return (e.table.hi + e.tail) * exp2i(e.k);
+}
+vdouble expm1(vdouble x, vint& special) {
+    special = ~(abs(x) <= 707.0) | (abs(x) < 0x1p-54);
+    vdouble small = x + x * (x * horner(x, expm1Taylor));
+    vint n;
+    vdouble nd = roundToInt(x * invLn2x32, n);
+    vdouble r = (x - nd * ln2x32Hi) - nd * ln2x32Lo;
+    expReduction e = reduceExp(n, r);
+    vdouble scale = exp2i(e.k);
+    dd s = twoSum(e.table.hi * scale, splat(-1.0));
+    return select(abs(x) < 0.3465, small, s.hi + (s.lo + e.tail * scale));
+}
+
+// c ~ 1 / m for the 64 leading mantissa bins together with -log(c) as double-double,
+// bins at or above 1.5 are taken relative to m / 2 so that log(x) never cancels near 1
+constexpr double logTable[64][3] = {
+    {0x1.0000000000000p+0, 0x0.0p+0, 0x0.0p+0},
+    {0x1.f44659e4a4271p-1, 0x1.7b91b07d5b126p-6, -0x1.6d80ab38e9430p-62},
+    {0x1.ecc07b301ecc0p-1, 0x1.39e87b9febd68p-5, -0x1.5bfa937f551b7p-59},
+    {0x1.e573ac901e574p-1, 0x1.b42dd711971b9p-5, 0x1.0a34531f67db5p-59},
+    {0x1.de5d6e3f8868ap-1, 0x1.16536eea37ae3p-4, 0x1.2189705cf74cap-58},
+    {0x1.d77b654b82c34p-1, 0x1.51b073f06183cp-4, -0x1.5b61c65e5741ap-58},
+    {0x1.d0cb58f6ec074p-1, 0x1.8c345d6319b23p-4, -0x1.294d2f5668495p-58},
+    {0x1.ca4b3055ee191p-1, 0x1.c5e548f5bc743p-4, 0x1.2eb0bf7c0b0d9p-59},
+    {0x1.c3f8f01c3f8f0p-1, 0x1.fec9131dbeabcp-4, -0x1.5746b9981b36cp-58},
+    {0x1.bdd2b899406f7p-1, 0x1.1b72ad52f67a2p-3, -0x1.fbe7ee5c69946p-57},
+    {0x1.b7d6c3dda338bp-1, 0x1.371fc201e8f75p-3, 0x1.e6cb62af18a02p-62},
+    {0x1.b2036406c80d9p-1, 0x1.526e5e3a1b438p-3, -0x1.546ff8a470d3ap-57},
+    {0x1.ac5701ac5701bp-1, 0x1.6d60fe719d21bp-3, 0x1.d551d97132e87p-57},
+    {0x1.a6d01a6d01a6dp-1, 0x1.87fa06520c911p-3, -0x1.9f7fdbfa08d9ap-57},
+    {0x1.a16d3f97a4b02p-1, 0x1.a23bc1fe2b561p-3, 0x1.24dc46c1ea664p-57},
+    {0x1.9c2d14ee4a102p-1, 0x1.bc286742d8cd4p-3, 0x1.cfce744870f57p-58},
+    {0x1.970e4f80cb872p-1, 0x1.d5c216b4fbb94p-3, -0x1.a37794d03657dp-58},
+    {0x1.920fb49d0e229p-1, 0x1.ef0adcbdc5935p-3, 0x1.e8637950dc20dp-57},
+    {0x1.8d3018d3018d3p-1, 0x1.0402594b4d041p-2, -0x1.08ec217a5022dp-57},
+    {0x1.886e5f0abb04ap-1, 0x1.1058bf9ae4ad4p-2, 0x1.3f415699663ecp-63},
+    {0x1.83c977ab2beddp-1, 0x1.1c898c16999fbp-2, 0x1.9f1a39d500e3cp-56},
+    {0x1.7f405fd017f40p-1, 0x1.2895a13de86a4p-2, 0x1.7ad24c13f040fp-56},
+    {0x1.7ad2208e0ecc3p-1, 0x1.347dd9a987d56p-2, -0x1.16ea62c048cfbp-56},
+    {0x1.767dce434a9b1p-1, 0x1.404308686a7e4p-2, -0x1.f79f6c1059cdbp-57},
+    {0x1.724287f46debcp-1, 0x1.4be5f957778a1p-2, -0x1.4b366b609027ap-58},
+    {0x1.6e1f76b4337c7p-1, 0x1.5767717455a6cp-2, -0x1.fb2a49af933e8p-57},
+    {0x1.6a13cd1537290p-1, 0x1.62c82f2b9c796p-2, -0x1.090a0dd59fe35p-58},
+    {0x1.661ec6a5122f9p-1, 0x1.6e08eaa2ba1e4p-2, -0x1.bfb1b39ca3a0fp-56},
+    {0x1.623fa77016240p-1, 0x1.792a55fdd47a1p-2, 0x1.f057691fe9ed7p-56},
+    {0x1.5e75bb8d015e7p-1, 0x1.842d1da1e8b18p-2, 0x1.54ec519784677p-56},
+    {0x1.5ac056b015ac0p-1, 0x1.8f11e873662c8p-2, 0x1.f85da755a61a3p-56},
+    {0x1.571ed3c506b3ap-1, 0x1.99d958117e08ap-2, -0x1.315b444ee1f38p-56},
+    {0x1.5390948f40febp+0, -0x1.214456d0eb8d5p-2, 0x1.50a2dca28b3edp-58},
+    {0x1.5015015015015p+0, -0x1.16b5ccbacfb73p-2, -0x1.56fbd28b40935p-56},
+    {0x1.4cab88725af6ep+0, -0x1.0c42d676162e2p-2, 0x1.5a74e18a8bb85p-56},
+    {0x1.49539e3b2d067p+0, -0x1.01eae5626c691p-2, -0x1.d9f5bd0b5b348p-57},
+    {0x1.460cbc7f5cf9ap+0, -0x1.ef5ade4dcffe5p-3, -0x1.7754d2238f75fp-58},
+    {0x1.42d6625d51f87p+0, -0x1.db13db0d48941p-3, 0x1.8af715b0349a4p-57},
+    {0x1.3fb013fb013fbp+0, -0x1.c6ffbc6f00f71p-3, 0x1.ae58b2c57a4a5p-57},
+    {0x1.3c995a47babe7p+0, -0x1.b31d8575bce3bp-3, 0x1.0d4eace1aa537p-59},
+    {0x1.3991c2c187f63p+0, -0x1.9f6c407089663p-3, 0x1.52979a7e86605p-57},
+    {0x1.3698df3de0748p+0, -0x1.8beafeb38fe8fp-3, 0x1.54aae92cd0b87p-59},
+    {0x1.33ae45b57bcb2p+0, -0x1.7898d85444c74p-3, -0x1.be3dbaf3ec804p-60},
+    {0x1.30d190130d190p+0, -0x1.6574ebe8c1339p-3, -0x1.c5961e173bc82p-57},
+    {0x1.2e025c04b8097p+0, -0x1.527e5e4a1b58dp-3, 0x1.b8d4b411cadffp-60},
+    {0x1.2b404ad012b40p+0, -0x1.3fb45a59928cap-3, 0x1.d87e6a354d057p-57},
+    {0x1.288b01288b013p+0, -0x1.2d1610c86813dp-3, -0x1.d997036941a6dp-60},
+    {0x1.25e22708092f1p+0, -0x1.1aa2b7e23f729p-3, -0x1.6e44389934420p-57},
+    {0x1.23456789abcdfp+0, -0x1.08598b59e3a07p-3, 0x1.fd7009902bf32p-57},
+    {0x1.20b470c67c0d9p+0, -0x1.ec739830a1126p-4, -0x1.eea033743f95bp-58},
+    {0x1.1e2ef3b3fb874p+0, -0x1.c885801bc4b20p-4, 0x1.5c734aa6598fcp-58},
+    {0x1.1bb4a4046ed29p+0, -0x1.a4e7640b1bc38p-4, 0x1.9b5ca203e4259p-58},
+    {0x1.19453808ca29cp+0, -0x1.8197e2f40e3f0p-4, 0x1.230690020895fp-59},
+    {0x1.16e0689427379p+0, -0x1.5e95a4d9791cdp-4, 0x1.4c78ba3a3baf6p-58},
+    {0x1.1485f0e0acd3bp+0, -0x1.3bdf5a7d1ee5ep-4, -0x1.f52eda76b68acp-60},
+    {0x1.12358e75d3033p+0, -0x1.1973bd1465561p-4, 0x1.7aac1b3d35680p-58},
+    {0x1.0fef010fef011p+0, -0x1.eea31c006b87cp-5, 0x1.7c9f9276f6cd8p-60},
+    {0x1.0db20a88f4696p+0, -0x1.aaef2d0fb1108p-5, -0x1.68d4eed0b82aep-59},
+    {0x1.0b7e6ec259dc8p+0, -0x1.67c94f2d4bb65p-5, -0x1.0413e6505e5f9p-59},
+    {0x1.0953f39010954p+0, -0x1.252f32f8d1840p-5, -0x1.ae021b67a9ba8p-61},
+    {0x1.073260a47f7c6p+0, -0x1.c63d2ec14aad7p-6, -0x1.8fe7acbca131dp-63},
+    {0x1.05197f7d73404p+0, -0x1.432a925980cbcp-6, 0x1.8cdaf39004193p-60},
+    {0x1.03091b51f5e1ap+0, -0x1.82448a388a283p-7, -0x1.04b16137f0970p-62},
+    {0x1.0000000000000p+0, 0x0.0p+0, 0x0.0p+0},
+};
+constexpr double ln2Hi = 0x1.62e42fee00000p-1;
+constexpr double ln2Lo = 0x1.a39ef35793c76p-33;
+// log1p(f) - f + f^2 / 2 divided by f^3 on |f| <= 1 / 64
+constexpr double log1pPoly[] = {
+    0x1.5555555555555p-2, -0x1p-2, 0x1.999999999999ap-3, -0x1.5555555555555p-3,
+    0x1.2492492492492p-3, -0x1p-3,  0x1.c71c71c71c71cp-4, -0x1.999999999999ap-4,
+    0x1.745d1745d1746p-4, -0x1.5555555555555p-4};
+
+// log(x) as double-double for positive, normal and finite x
+inline dd logCore(vdouble x) {
+    vint bits = (vint) x;
+    vint index = (bits >> 46) & 63;
+    vint upper = index >> 5;
+    vint k = ((bits >> 52) & 0x7ff) - 1023 + upper;
+    vdouble m = (vdouble) ((bits & 0x000fffffffffffff) | ((1023 - upper) << 52));
+    vdouble c, tHi, tLo;
+    for (size_t i = 0; i < lanes; ++i) {
+        c[i] = logTable[index[i]][0];
+        tHi[i] = logTable[index[i]][1];
+        tLo[i] = logTable[index[i]][2];
+    }
+    dd p = twoProduct(m, c);
+    dd f = twoSum(p.hi - 1.0, p.lo);
+    dd q = twoProduct(f.hi, f.hi);
+    vdouble poly = f.hi * q.hi * horner(f.hi, log1pPoly);
+    vdouble kd = toDouble(k);
+    dd a = twoSum(kd * ln2Hi, tHi);
+    dd b = twoSum(a.hi, f.hi);
+    dd s = twoSum(b.hi, -0.5 * q.hi);
+    vdouble lo = a.lo + b.lo + s.lo + kd * ln2Lo + tLo + f.lo - 0.5 * q.lo - f.hi * f.lo + poly;
+    return twoSum(s.hi, lo);
+}
+inline vint logSpecial(vdouble x) { return ~(x >= 0x1p-1022 && x <= 0x1.fffffffffffffp+1023); }
+inline vdouble scaleDD(dd x, double hi, double lo) {
+    dd p = twoProduct(x.hi, splat(hi));
+    return p.hi + (p.lo + x.hi * lo + x.lo * hi);
+}
+
+vdouble log(vdouble x, vint& special) {
+    special = logSpecial(x);
+    dd l = logCore(x);
+    return l.hi + l.lo;
+}
+vdouble log2(vdouble x, vint& special) {
+    special = logSpecial(x);
+    return scaleDD(logCore(x), 0x1.71547652b82fep+0, 0x1.777d0ffda0d24p-56);
+}
+vdouble log10(vdouble x, vint& special) {
+    special = logSpecial(x);
+    return scaleDD(logCore(x), 0x1.bcb7b1526e50ep-2, 0x1.95355baaafad3p-57);
+}
+
+vdouble pow(vdouble x, vdouble y, vint& special) {
+    special = logSpecial(x) | ~(abs(y) <= 0x1p1000) | (x == 1.0);
+    dd l = logCore(x);
+    dd t = twoProduct(y, l.hi);
+    t = fastTwoSum(t.hi, t.lo + y * l.lo);
+    special |= ~(abs(t.hi) <= 707.0);
+    return expCore(t.hi, t.lo);
+}
+
+constexpr double twoOverPi = 0x1.45f306dc9c883p-1;
+constexpr double pio2[] = {0x1.921fb54400000p+0, 0x1.0b4611a600000p-34, 0x1.3198a2e000000p-69,
+                           0x1.b839a252049c1p-104};
+// sin(r) = r + r^3 S(r^2), cos(r) = 1 - r^2 / 2 + r^4 C(r^2) on |r| <= pi / 4
+constexpr double sinPoly[] = {-0x1.5555555555555p-3, 0x1.1111111111111p-7,
+                              -0x1.a01a01a01a01ap-13, 0x1.71de3a556c734p-19,
+                              -0x1.ae64567f544e4p-26, 0x1.6124613a86d09p-33,
+                              -0x1.ae7f3e733b81fp-41, 0x1.952c77030ad4ap-49};
+constexpr double cosPoly[] = {0x1.5555555555555p-5,  -0x1.6c16c16c16c17p-10,
+                              0x1.a01a01a01a01ap-16, -0x1.27e4fb7789f5cp-22,
+                              0x1.1eed8eff8d898p-29, -0x1.93974a8c07c9dp-37,
+                              0x1.ae7f3e733b81fp-45, -0x1.6827863b97d97p-53};
+constexpr double sinPolyFast[] = {-0x1.5555555555555p-3, 0x1.1111111111111p-7,
+                                  -0x1.a01a01a01a01ap-13, 0x1.71de3a556c734p-19,
+                                  -0x1.ae64567f544e4p-26, 0x1.6124613a86d09p-33,
+                                  -0x1.ae7f3e733b81fp-41};
+constexpr double cosPolyFast[] = {0x1.5555555555555p-5,  -0x1.6c16c16c16c17p-10,
+                                  0x1.a01a01a01a01ap-16, -0x1.27e4fb7789f5cp-22,
+                                  0x1.1eed8eff8d898p-29, -0x1.93974a8c07c9dp-37,
+                                  0x1.ae7f3e733b81fp-45};
+
+struct sincosResult {
+    vdouble sin;
+    vdouble cos;
+    vint quadrant;
+};
+template <bool fast> inline sincosResult sincosCore(vdouble x, vint& special) {
+    special = ~(abs(x) <= 0x1p17) | (abs(x) < 0x1p-26);
+    vint n;
+    vdouble nd = roundToInt(x * twoOverPi, n);
+    dd b = twoSum(x - nd * pio2[0], -nd * pio2[1]);
+    dd c = twoSum(b.hi, -nd * pio2[2]);
+    dd r = fastTwoSum(c.hi, b.lo + c.lo - nd * pio2[3]);
+    vdouble z = r.hi * r.hi;
+    vdouble s, w;
+    if constexpr (fast) {
+        s = horner(z, sinPolyFast);
+        w = z * z * horner(z, cosPolyFast);
+    } else {
+        s = horner(z, sinPoly);
+        w = z * z * horner(z, cosPoly);
+    }
+    sincosResult result;
+    result.sin = r.hi + (r.lo + r.hi * z * s);
+    vdouble hz = 0.5 * z;
+    vdouble v = 1.0 - hz;
+    result.cos = v + (((1.0 - v) - hz) + (w - r.hi * r.lo));
+    result.quadrant = n & 3;
+    return result;
+}
+template <bool fast> vdouble sin(vdouble x, vint& special) {
+    sincosResult sc = sincosCore<fast>(x, special);
+    vdouble result = select((sc.quadrant & 1) != 0, sc.cos, sc.sin);
+    return select((sc.quadrant & 2) != 0, -result, result);
+}
+template <bool fast> vdouble cos(vdouble x, vint& special) {
+    sincosResult sc = sincosCore<fast>(x, special);
+    vdouble result = select((sc.quadrant & 1) != 0, -sc.sin, sc.cos);
+    return select((sc.quadrant & 2) != 0, -result, result);
+}
+vdouble tan(vdouble x, vint& special) {
+    sincosResult sc = sincosCore<false>(x, special);
+    vint odd = (sc.quadrant & 1) != 0;
+    return select(odd, -sc.cos, sc.sin) / select(odd, sc.sin, sc.cos);
+}
+
+// atan(t) = t - t^3 P(t^2) on |t| <= 7 / 16
+constexpr double atanPoly[] = {
+    3.33333333333329318027e-01,  -1.99999999998764832476e-01, 1.42857142725034663711e-01,
+    -1.11111104054623557880e-01, 9.09088713343650656196e-02,  -7.69187620504482999495e-02,
+    6.66107313738753120669e-02,  -5.83357013379057348645e-02, 4.97687799461593236017e-02,
+    -3.65315727442169155270e-02, 1.62858201153657823623e-02};
+// atan(0.5), atan(1), atan(1.5), atan(inf) as double-double
+constexpr double atanHi[] = {0.0, 4.63647609000806093515e-01, 7.85398163397448278999e-01,
+                             9.82793723247329054082e-01, 1.57079632679489655800e+00};
+constexpr double atanLo[] = {0.0, 2.26987774529616870924e-17, 3.06161699786838301793e-17,
+                             1.39033110312309984516e-17, 6.12323399573676603587e-17};
+
+// atan(|x|) for finite x
+inline vdouble atanCore(vdouble x) {
+    vdouble ax = abs(x);
+    vint id1 = ax >= 0.4375, id2 = ax >= 0.6875, id3 = ax >= 1.1875, id4 = ax >= 2.4375;
+    vint id = -(id1 + id2 + id3 + id4);
+    vdouble num = select(id4, splat(-1.0),
+                         select(id3, ax - 1.5,
+                                select(id2, ax - 1.0, select(id1, 2.0 * ax - 1.0, ax))));
+    vdouble den = select(id4, ax,
+                         select(id3, 1.0 + 1.5 * ax,
+                                select(id2, ax + 1.0, select(id1, 2.0 + ax, splat(1.0)))));
+    vdouble t = num / den;
+    vdouble hi, lo;
+    for (size_t i = 0; i < lanes; ++i) {
+        hi[i] = atanHi[id[i]];
+        lo[i] = atanLo[id[i]];
+    }
+    vdouble z = t * t;
+    vdouble p = t * z * horner(z, atanPoly);
+    return hi - ((p - lo) - t);
+}
+vdouble atan(vdouble x, vint& special) {
+    special = ~(abs(x) <= 0x1p66) | (abs(x) < 0x1p-27);
+    return copysign(atanCore(x), x);
+}
+
+constexpr double pi = 0x1.921fb54442d18p+1;
+constexpr double piLo = 0x1.1a62633145c07p-53;
+
+vdouble atan2(vdouble y, vdouble x, vint& special) {
+    vdouble ax = abs(x), ay = abs(y);
+    special = ~(ax >= 0x1p-1022 && ax <= 0x1p1000 && ay >= 0x1p-1022 && ay <= 0x1p1000);
+    vdouble ratio = ay / ax;
+    special |= ~(ratio >= 0x1p-1000 && ratio <= 0x1p60);
+    vdouble z = atanCore(ratio);
+    vdouble result = select(x < 0.0, pi - (z - piLo), z);
+    return copysign(result, y);
+}
+
+vdouble tanh(vdouble x, vint& special) {
+    vdouble ax = abs(x);
+    special = ~(ax >= 0x1p-55);
+    vint large = ax >= 1.0;
+    vint ignored;
+    vdouble t = expm1(select(large, 2.0 * ax, -2.0 * ax), ignored);
+    vdouble result = select(large, 1.0 - 2.0 / (t + 2.0), -t / (t + 2.0));
+    result = select(ax >= 22.0, splat(1.0), result);
+    return copysign(result, x);
+}
+vdouble sinh(vdouble x, vint& special) {
+    vdouble ax = abs(x);
+    special = ~(ax <= 22.0) | (ax < 0x1p-28);
+    vint ignored;
+    vdouble t = expm1(ax, ignored);
+    vdouble result = select(ax < 1.0, 2.0 * t - t * t / (t + 1.0), t + t / (t + 1.0));
+    return copysign(0.5 * result, x);
+}
+vdouble cosh(vdouble x, vint& special) {
+    vdouble ax = abs(x);
+    special = ~(ax <= 22.0);
+    vint ignored;
+    vdouble t = expm1(ax, ignored);
+    vdouble w = 1.0 + t;
+    vdouble e = exp(ax, ignored);
+    return select(ax < 0.3465735902799726, 1.0 + (t * t) / (w + w), 0.5 * e + 0.5 / e);
+}
+
+// erf(c) and the leading Taylor coefficient of erf around c = j / 2 as double-double, followed by
+// the remaining coefficients up to degree 18
+constexpr double erfTable[13][21] = {
+    {0x0.0p+0, 0x0.0p+0, 0x1.20dd750429b6dp+0, 0x1.1ae3a914fed80p-56,
+     -0x0.0p+0, -0x1.812746b0379e7p-2, 0x0.0p+0, 0x1.ce2f21a042be2p-4,
+     -0x0.0p+0, -0x1.b82ce31288b51p-6, 0x0.0p+0, 0x1.565bcd0e6a53fp-8,
+     -0x0.0p+0, -0x1.c02db40040b86p-11, 0x0.0p+0, 0x1.f9a326f9b89b7p-14,
+     -0x0.0p+0, -0x1.f4d25c3e0c2ebp-17, 0x0.0p+0, 0x1.b9e6c9dc651a3p-20,
+     -0x0.0p+0},
+    {0x1.0a7ef5c18edd2p-1, 0x1.5e809f1a31a28p-56, 0x1.c1efca49a5011p-1, 0x1.4c081d7f49500p-55,
+     -0x1.c1efca49a5011p-2, -0x1.2bf531866e00cp-3, 0x1.76f27de80980ep-3, 0x1.dfeeb5a3e3346p-8,
+     -0x1.99f13b26a7676p-5, 0x1.623c617f0f515p-8, 0x1.493d480930d14p-7, -0x1.1c1645ee62c3cp-9,
+     -0x1.9b6f2543cb46cp-10, 0x1.04c10aa85c4bdp-11, 0x1.9bca40e3c05b8p-13, -0x1.658951157f288p-14,
+     -0x1.4c433b5aa6987p-16, 0x1.8e6ed701aefaap-17, 0x1.a501d0174e6c1p-20, -0x1.7852d902db3dep-20,
+     -0x1.71eb964293287p-24},
+    {0x1.af767a741088bp-1, -0x1.c97f778122797p-56, 0x1.a911f096fbc26p-2, -0x1.086a09f735b33p-56,
+     -0x1.a911f096fbc26p-2, 0x1.1b614b0f52819p-3, 0x1.1b614b0f52819p-4, -0x1.1b614b0f52819p-4,
+     0x1.2e45a565ad570p-8, 0x1.f096fd702f0efp-7, -0x1.391146bb981a2p-8, -0x1.ee30d995fae39p-10,
+     0x1.4176c4374eb1ep-10, 0x1.66b6afbde3cc2p-14, -0x1.a38bca0efc115p-13, 0x1.3a035a7960672p-16,
+     0x1.8dbd3052dd336p-16, -0x1.6fa38387ffecfp-18, -0x1.17503b2712bd4p-19, 0x1.c7d4267b540c0p-21,
+     0x1.08c1e370a1521p-23},
+    {0x1.eea5557137ae0p-1, -0x1.385e445f2c96dp-55, 0x1.e723726b824a9p-4, -0x1.2203197eea764p-59,
+     -0x1.6d5a95d0a1b7fp-3, 0x1.1c2a02beb6ab8p-3, -0x1.6d5a95d0a1b7fp-5, -0x1.e723726b824a9p-7,
+     0x1.3ca3d72c47e3bp-6, -0x1.36d73a61dbabfp-8, -0x1.35ae4e395fa0cp-9, 0x1.c0380c3978d47p-10,
+     -0x1.85b5f522cea21p-14, -0x1.0acef87389254p-12, 0x1.45db0652058b6p-14, 0x1.2d3d58b8fbd36p-16,
+     -0x1.d8dcc76abaeadp-17, 0x1.3fad4f62b4b13p-21, 0x1.9b5e588bf60cbp-20, -0x1.68e51003dd11fp-22,
+     -0x1.bfb4d6727bc30p-24},
+    {0x1.fd9ae142795e3p-1, 0x1.972801904b9a3p-56, 0x1.529b9e8cf9a1ep-6, 0x1.b47becf12c4e4p-61,
+     -0x1.529b9e8cf9a1ep-5, 0x1.8b0ae3a478923p-5, -0x1.1a2c59757ab19p-5, 0x1.ace7404c2b226p-7,
+     0x1.e1935ea65d580p-12, -0x1.bae0ab9d91458p-9, 0x1.a11434425e8e8p-10, -0x1.a46c56b1bf347p-15,
+     -0x1.13917bd98236ap-12, 0x1.b3399158e1fdap-14, 0x1.5efa63f686f78p-18, -0x1.1082811096fe0p-16,
+     0x1.09282c4c7901bp-18, 0x1.00feae4932917p-20, -0x1.77fa2b27b4e3ep-21, 0x1.fc672c47d867ap-25,
+     0x1.020dc680f96e9p-24},
+    {0x1.ffcaa8f4c9beap-1, 0x1.b0cee160116f9p-55, 0x1.1d83170fbf6fbp-9, 0x1.ea3671efbb74ap-63,
+     -0x1.64e3dcd3af4bap-8, 0x1.119da0c46ccb1p-7, -0x1.1a89b97ceac69p-7, 0x1.90e81283faacep-8,
+     -0x1.6ecdbf67c97f8p-9, 0x1.1c610bcb9f2f4p-11, 0x1.11551df364bafp-12, -0x1.067178c82ec16p-12,
+     0x1.4a84485ac08c0p-14, 0x1.58bd113f5a0acp-18, -0x1.d87265f65a35ap-17, 0x1.3acdbedf3bf9dp-18,
+     0x1.857cc63e5cc55p-23, -0x1.584349ead6a3ep-21, 0x1.80e36bab128b3p-23, 0x1.356cf87d24464p-26,
+     -0x1.97f31e43731b3p-26},
+    {0x1.fffd1ac4135f9p-1, 0x1.eeafa1ecd6cefp-55, 0x1.2408e9ba3327fp-13, -0x1.7e1d81587040cp-67,
+     -0x1.b60d5e974cbbep-12, 0x1.9db74b1d1dcdep-11, -0x1.11c85b1e8ff57p-10, 0x1.0a7b5546b5147p-10,
+     -0x1.82f235b05094ep-11, 0x1.998b47c657967p-12, -0x1.1aa5e236f52b3p-13, 0x1.d2a33c9487ebdp-17,
+     0x1.05ff38163998dp-16, -0x1.6a2c7a4c7a4fap-17, 0x1.96c6821168fd5p-19, 0x1.08f85acf3b805p-23,
+     -0x1.e5e7b05db7fdfp-22, 0x1.63eb0f4262611p-23, -0x1.4176b80e4a09cp-27, -0x1.01510b19ef62fp-26,
+     0x1.9a52b11d33e56p-28},
+    {0x1.ffffe710d565ep-1, 0x1.c9ea52d76dc04p-55, 0x1.6a597219a93dap-18, -0x1.cbf8fbc2cd5cdp-72,
+     -0x1.3d0e43d67415ep-16, 0x1.62ccea63cb0c5p-15, -0x1.1c07721ac7fe5p-14, 0x1.586bafc9b9889p-14,
+     -0x1.46153fb989863p-14, 0x1.e827fafaa2516p-15, -0x1.1f6304de1316ep-15, 0x1.013525f7fb03fp-16,
+     -0x1.377413bec5d3bp-18, 0x1.dd7f3b681270fp-22, 0x1.dc7faa4de456ap-22, -0x1.43ea60cc4f9a7p-22,
+     0x1.8c7db95907d1cp-24, -0x1.89d268eba17d8p-28, -0x1.1be8ea4e7bf8ep-27, 0x1.153e8c87cc9cbp-28,
+     -0x1.837fcf76d39fbp-31},
+    {0x1.ffffff7b91176p-1, 0x1.0b2865615db40p-56, 0x1.10b1488aeb235p-23, -0x1.cd75b4828c0c0p-81,
+     -0x1.10b1488aeb235p-21, 0x1.603a5308c50dap-20, -0x1.4980e25286cabp-19, 0x1.da5f10dc53b57p-19,
+     -0x1.10505376d0801p-18, 0x1.fd7c656d671e1p-19, -0x1.88c7af5f0dc2ap-19, 0x1.f42465a91b073p-20,
+     -0x1.0475684ebb659p-20, 0x1.ae54ff8450a05p-22, -0x1.021190700479cp-23, 0x1.2b7c6c451e776p-26,
+     0x1.94740d2f7339fp-28, -0x1.6c067c0ac6727p-28, 0x1.0da723a1d63a4p-29, -0x1.74c423b7aa2f7p-32,
+     -0x1.df584753c2898p-35},
+    {0x1.fffffffe4fa30p-1, 0x1.d166bcb681c7bp-57, 0x1.f1e3523b41d7dp-30, -0x1.7303536c50b37p-84,
+     -0x1.180fde4155096p-27, 0x1.99b8665618d99p-26, -0x1.b598cb4614debp-25, 0x1.6b1baf456a84ep-24,
+     -0x1.e650e3452e100p-24, 0x1.0d678f85bb98fp-23, -0x1.f5f31b5e1314cp-24, 0x1.8d2e638d9f75bp-24,
+     -0x1.0c3a43aa7835ep-24, 0x1.34ee6a127de73p-25, -0x1.2cd5b428c9554p-26, 0x1.e48b0513e1226p-28,
+     -0x1.319ea81e5b210p-29, 0x1.fb1e3c9b17225p-32, -0x1.2185fc834f1cbp-47, -0x1.bf6b73ddaa6bap-35,
+     0x1.bf6f3cba7b9d3p-36},
+    {0x1.fffffffffc9e8p-1, -0x1.a759f7738935fp-56, 0x1.13af4f04f9998p-36, -0x1.0532e647cd418p-90,
+     -0x1.589b22c637ffep-34, 0x1.196da0aa69776p-32, -0x1.516d3cb76c2a8p-31, 0x1.3c51d0aaa4419p-30,
+     -0x1.e23586e1d0236p-30, 0x1.32c72906e2a3cp-29, -0x1.4bcea4d4fbdb3p-29, 0x1.3505fd6432e1ep-29,
+     -0x1.f41226936ced5p-30, 0x1.617998494db7cp-30, -0x1.b5969cc99e94fp-31, 0x1.d9d11175dbd2ep-32,
+     -0x1.be10acec703b8p-33, 0x1.6819f8bc9dce8p-34, -0x1.e3ed193f21c44p-36, 0x1.f72d392993523p-38,
+     -0x1.3476bc85ffd2cp-40},
+    {0x1.fffffffffffbep-1, -0x1.182b326b228dcp-55, 0x1.7258610b3b233p-44, -0x1.60bc7761ca394p-101,
+     -0x1.fd39856f71506p-42, 0x1.cb12e2f5ebf8fp-40, -0x1.31011e96bfdedp-38, 0x1.3e4a1f8967022p-37,
+     -0x1.0f6e89cd80910p-36, 0x1.84a4e0fbb7accp-36, -0x1.dc38bc64eeb79p-36, 0x1.fa7a9e1187297p-36,
+     -0x1.d8771a9aefedbp-36, 0x1.85963d3fa1f4ep-36, -0x1.1d8920b8301b7p-36, 0x1.7554a960d4f69p-37,
+     -0x1.b40ce266d5a1fp-38, 0x1.c6a7240f1900ep-39, -0x1.a5a856dc3c8d1p-40, 0x1.5917a44387181p-41,
+     -0x1.eaccbfa9e3b41p-43},
+    {0x1.0000000000000p+0, -0x1.8cf81557d20b6p-56, 0x1.2dc119095729fp-52, -0x1.1566d13fe4564p-106,
+     -0x1.c4a1a58e02beep-50, 0x1.be584a5dd0ee0p-48, -0x1.45542efe11f93p-46, 0x1.75a81c0090eefp-45,
+     -0x1.5ff7d49a4b77ep-44, 0x1.177209e5be27dp-43, -0x1.7d75137ef0936p-43, 0x1.c645ed673f594p-43,
+     -0x1.dd502a7c15df2p-43, 0x1.be5ea11961469p-43, -0x1.760caa2d5df63p-43, 0x1.1a53adc08df04p-43,
+     -0x1.8156a89556529p-44, 0x1.dcb8fbf38a86fp-45, -0x1.0ba12f3a35e31p-45, 0x1.10abb0be56ee1p-46,
+     -0x1.f738f468277d4p-48},
+};
+
+vdouble erf(vdouble x, vint& special) {
+    special = ~(abs(x) >= 0x1p-28);
+    vdouble ax = abs(x);
+    vint n;
+    roundToInt(select(ax < 6.0, 2.0 * ax, splat(12.0)), n);
+    vdouble h = ax - 0.5 * toDouble(n);
+    vdouble p = splat(0.0), e, eLo, c, cLo;
+    for (size_t k = 20; k >= 4; --k) {
+        vdouble coefficient;
+        for (size_t i = 0; i < lanes; ++i) coefficient[i] = erfTable[n[i]][k];
+        p = (p + coefficient) * h;
+    }
+    for (size_t i = 0; i < lanes; ++i) {
+        e[i] = erfTable[n[i]][0];
+        eLo[i] = erfTable[n[i]][1];
+        c[i] = erfTable[n[i]][2];
+        cLo[i] = erfTable[n[i]][3];
+    }
+    dd leading = twoProduct(h, c);
+    dd s = twoSum(e, leading.hi);
+    vdouble result = s.hi + (s.lo + eLo + leading.lo + h * (cLo + p));
+    result = select(ax < 6.0, result, splat(1.0));
+    return copysign(result, x);
+}
+
+vdouble sqrt(vdouble x, vint& special) {
+    special = ~(x >= 0.0);
+    vdouble result;
+    for (size_t i = 0; i < lanes; ++i) result[i] = __builtin_sqrt(special[i] ? 1.0 : x[i]);
+    return result;
+}
+
+using kernel1 = vdouble (*)(vdouble, vint&);
+using kernel2 = vdouble (*)(vdouble, vdouble, vint&);
+
+void apply(kernel1 kernel, double (*fallback)(double), span<const double> x, span<double> result) {
+    size_t n = result.size();
+    for (size_t i = 0; i < n; i += lanes) {
+        size_t count = n - i < lanes ? n - i : lanes;
+        vdouble in = splat(1.0), out;
+        memcpy(&in, &x[i], count * sizeof(double));
+        vint special;
+        out = kernel(in, special);
+        if (any(special)) {
+            for (size_t l = 0; l < count; ++l) {
+                if (special[l]) out[l] = fallback(in[l]);
+            }
+        }
+        memcpy(&result[i], &out, count * sizeof(double));
+    }
+}
+void apply(kernel2 kernel, double (*fallback)(double, double), span<const double> x,
+           span<const double> y, span<double> result) {
+    size_t n = result.size();
+    for (size_t i = 0; i < n; i += lanes) {
+        size_t count = n - i < lanes ? n - i : lanes;
+        vdouble in1 = splat(1.0), in2 = splat(1.0), out;
+        memcpy(&in1, &x[i], count * sizeof(double));
+        memcpy(&in2, &y[i], count * sizeof(double));
+        vint special;
+        out = kernel(in1, in2, special);
+        if (any(special)) {
+            for (size_t l = 0; l < count; ++l) {
+                if (special[l]) out[l] = fallback(in1[l], in2[l]);
+            }
+        }
+        memcpy(&result[i], &out, count * sizeof(double));
+    }
+}
+
+} // namespace
+
+bool hasKernel(FunctionType type, Accuracy accuracy) {
+    // fma is correctly rounded, so its column loop gives the same results as <cmath>
+    if (type == FunctionType::fma) {
+        return true;
+    }
+    if (accuracy == Accuracy::standard) {
+        return false;
+    }
+    switch (type) {
+        case FunctionType::exp:
+        case FunctionType::exp2:
+        case FunctionType::expm1:
+        case FunctionType::log:
+        case FunctionType::log2:
+        case FunctionType::pow:
+        case FunctionType::sqrt:
+        case FunctionType::sin:
+        case FunctionType::cos:
+        case FunctionType::atan:
+        case FunctionType::atan2:
+        case FunctionType::erf: return true;
+        case FunctionType::log10:
+        case FunctionType::tan:
+        case FunctionType::sinh:
+        case FunctionType::cosh:
+        case FunctionType::tanh: return accuracy == Accuracy::fast;
+        default: return false;
+    }
+}
+
+void call(FunctionType type, Accuracy accuracy, span<const span<const double>> params,
+          span<double> result) {
+    const bool fast = accuracy == Accuracy::fast;
+    switch (type) {
+        case FunctionType::exp: return apply(exp, std::exp, params[0], result);
+        case FunctionType::exp2: return apply(exp2, std::exp2, params[0], result);
+        case FunctionType::expm1: return apply(expm1, std::expm1, params[0], result);
+        case FunctionType::log: return apply(log, std::log, params[0], result);
+        case FunctionType::log2: return apply(log2, std::log2, params[0], result);
+        case FunctionType::log10: return apply(log10, std::log10, params[0], result);
+        case FunctionType::pow: return apply(pow, std::pow, params[0], params[1], result);
+        case FunctionType::sqrt: return apply(sqrt, std::sqrt, params[0], result);
+        case FunctionType::sin: {
+            return apply(fast ? sin<true> : sin<false>, std::sin, params[0], result);
+        }
+        case FunctionType::cos: {
+            return apply(fast ? cos<true> : cos<false>, std::cos, params[0], result);
+        }
+        case FunctionType::tan: return apply(tan, std::tan, params[0], result);
+        case FunctionType::atan: return apply(atan, std::atan, params[0], result);
+        case FunctionType::atan2: return apply(atan2, std::atan2, params[0], params[1], result);
+        case FunctionType::sinh: return apply(sinh, std::sinh, params[0], result);
+        case FunctionType::cosh: return apply(cosh, std::cosh, params[0], result);
+        case FunctionType::tanh: return apply(tanh, std::tanh, params[0], result);
+        case FunctionType::erf: return apply(erf, std::erf, params[0], result);
+        case FunctionType::fma: {
+            for (size_t i = 0; i < result.size(); ++i) {
+                result[i] = std::fma(params[0][i], params[1][i], params[2][i]);
+            }
+            return;
+        }
+        default: error("Evaluation Error: no vectorized kernel for function");
+    }
+}
+
+void call(FunctionType type, span<const span<const int64_t>> params, span<int64_t> result) {
+    const size_t n = result.size();
+    switch (type) {
+        case FunctionType::popcount: {
+            for (size_t i = 0; i < n; ++i) result[i] = popcount(params[0][i]);
+            break;
+        }
+        case FunctionType::clz: {
+            for (size_t i = 0; i < n; ++i) result[i] = clz(params[0][i]);
+            break;
+        }
+        case FunctionType::ctz: {
+            for (size_t i = 0; i < n; ++i) result[i] = ctz(params[0][i]);
+            break;
+        }
+        case FunctionType::rotl: {
+            for (size_t i = 0; i < n; ++i) result[i] = rotl(params[0][i], params[1][i]);
+            break;
+        }
+        case FunctionType::rotr: {
+            for (size_t i = 0; i < n; ++i) result[i] = rotr(params[0][i], params[1][i]);
+            break;
+        }
+        case FunctionType::bswap: {
+            for (size_t i = 0; i < n; ++i) result[i] = bswap(params[0][i]);
+            break;
+        }
+        case FunctionType::bextract: {
+            for (size_t i = 0; i < n; ++i) {
+                result[i] = bextract(params[0][i], params[1][i], params[2][i]);
+            }
+            break;
+        }
+        case FunctionType::gcd: {
+            for (size_t i = 0; i < n; ++i) result[i] = gcd(params[0][i], params[1][i]);
+            break;
+        }
+        case FunctionType::modpow: {
+            for (size_t i = 0; i < n; ++i) {
+                if (params[1][i] < 0 || params[2][i] <= 0) {
+                    error("Evaluation Error: modpow needs a non-negative exponent and a positive "
+                          "modulus");
+                }
+                result[i] = modpow(params[0][i], params[1][i], params[2][i]);
+            }
+            break;
+        }
+        default: error("Evaluation Error: no vectorized kernel for function");
+    }
+}
+
+} // namespace evaluate::simd
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Functions.hpp"
+#include "Options.hpp"
+#include <span>
+
+namespace evaluate::simd {
+
+bool hasKernel(FunctionType type, Accuracy accuracy);
+
+// evaluates type element wise over the parameter columns,
+// all columns must have the same size as result
+void call(FunctionType type, Accuracy accuracy, std::span<const std::span<const double>> params,
+          std::span<double> result);
+
+// the same for the integer functions, which all have a column kernel
+void call(FunctionType type, std::span<const std::span<const int64_t>> params,
+          std::span<int64_t> result);
+
+} // namespace evaluate::simd
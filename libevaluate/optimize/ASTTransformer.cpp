@@ -0,0 +1,60 @@
+#include "ASTTransformer.hpp"
+
+using namespace std;
+
+namespace evaluate {
+
+unique_ptr<AST> ASTTransformer::transform(const AST& node) {
+    node.accept(*this);
+    return move(reg);
+}
+
+vector<unique_ptr<AST>> ASTTransformer::transformParameters(const FUNCTION& node) {
+    vector<unique_ptr<AST>> parameters{};
+    for (auto& p : node.getParameters()) {
+        parameters.emplace_back(transform(*p));
+    }
+    return parameters;
+}
+
+void ASTTransformer::visit(const VALUE& node) {
+    if (node.isFP()) {
+        reg = make_unique<VALUE>(node.getCodeRef(), node.asDouble());
+    } else {
+        reg = make_unique<VALUE>(node.getCodeRef(), node.asInt());
+    }
+}
+void ASTTransformer::visit(const VARIABLE& node) {
+    reg = make_unique<VARIABLE>(node.getCodeRef(), node.getIndex(), node.getName(),
+                                node.getValueType());
+}
+void ASTTransformer::visit(const FUNCTION& node) {
+    auto parameters = transformParameters(node);
+    reg = make_unique<FUNCTION>(node.getCodeRef(), node.getFunctionType(), node.getName(),
+                                move(parameters));
+}
+void ASTTransformer::visit(const POW& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const OR& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const XOR& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const AND& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const SHL& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const SHR& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const ADD& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const MINUS& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const MUL& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const DIV& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const MOD& node) { visitBinaryAST(node); }
+void ASTTransformer::visit(const UnaryMINUS& node) { visitUnaryAST(node); }
+void ASTTransformer::visit(const UnaryPLUS& node) { visitUnaryAST(node); }
+void ASTTransformer::visit(const UnaryCOMP& node) { visitUnaryAST(node); }
+// shared expressions stay shared, so they are not transformed
+void ASTTransformer::visit(const SHARED& node) {
+    reg = make_unique<SHARED>(node.getCodeRef(), node.getIndex(), node.getSharedExpression());
+}
+
+unique_ptr<AST> clone(const AST& node) {
+    ASTTransformer transformer;
+    return transformer.transform(node);
+}
+
+} // namespace evaluate
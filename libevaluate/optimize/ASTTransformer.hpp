@@ -0,0 +1,62 @@
+#pragma once
+
+#include "analyze/AST.hpp"
+#include "analyze/ASTVisitor.hpp"
+#include <concepts>
+#include <memory>
+#include <vector>
+
+namespace evaluate {
+
+// builds a new AST from an existing one, the default visits copy the node with transformed
+// children. passes override the visits of the nodes they rewrite
+class ASTTransformer : protected ASTVisitor {
+    protected:
+    std::unique_ptr<AST> reg;
+
+    public:
+    virtual ~ASTTransformer() noexcept = default;
+    virtual std::unique_ptr<AST> transform(const AST& node);
+
+    protected:
+    void visit(const VALUE& node) override;
+    void visit(const VARIABLE& node) override;
+    void visit(const FUNCTION& node) override;
+    void visit(const POW& node) override;
+    void visit(const OR& node) override;
+    void visit(const XOR& node) override;
+    void visit(const AND& node) override;
+    void visit(const SHL& node) override;
+    void visit(const SHR& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+    void visit(const MUL& node) override;
+    void visit(const DIV& node) override;
+    void visit(const MOD& node) override;
+    void visit(const UnaryMINUS& node) override;
+    void visit(const UnaryPLUS& node) override;
+    void visit(const UnaryCOMP& node) override;
+    void visit(const SHARED& node) override;
+
+    std::vector<std::unique_ptr<AST>> transformParameters(const FUNCTION& node);
+
+    template <typename ast>
+    requires std::derived_from<ast, BinaryAST>
+    void visitBinaryAST(const ast& node) {
+        auto l_expr = transform(node.getLExpr());
+        auto r_expr = transform(node.getRExpr());
+        reg = std::make_unique<ast>(node.getCodeRef(), std::move(l_expr), std::move(r_expr));
+    }
+
+    template <typename ast>
+    requires std::derived_from<ast, UnaryAST>
+    void visitUnaryAST(const ast& node) {
+        auto child = transform(node.getChild());
+        reg = std::make_unique<ast>(node.getCodeRef(), std::move(child));
+    }
+};
+
+// a copy of node
+std::unique_ptr<AST> clone(const AST& node);
+
+} // namespace evaluate
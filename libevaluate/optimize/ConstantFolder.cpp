@@ -0,0 +1,60 @@
+#include "ConstantFolder.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace evaluate {
+
+static bool isValue(const AST& node) { return node.getType() == AST::Type::VALUE; }
+
+// whether all operands of node are values and evaluating it cannot fail at runtime
+static bool isConstant(const AST& node) {
+    switch (node.getType()) {
+        case AST::Type::VALUE:
+        case AST::Type::VARIABLE:
+        case AST::Type::SHARED: return false;
+        case AST::Type::FUNCTION: {
+            auto& parameters = static_cast<const FUNCTION&>(node).getParameters();
+            return all_of(parameters.begin(), parameters.end(), [](auto& p) { return isValue(*p); });
+        }
+        case AST::Type::UnaryMINUS:
+        case AST::Type::UnaryPLUS:
+        case AST::Type::UnaryCOMP: return isValue(static_cast<const UnaryAST&>(node).getChild());
+        case AST::Type::DIV:
+        case AST::Type::MOD: {
+            // an integer division by zero is left to fail at runtime
+            auto& binary = static_cast<const BinaryAST&>(node);
+            if (isValue(binary.getRExpr())) {
+                auto& divisor = static_cast<const VALUE&>(binary.getRExpr());
+                if (!divisor.isFP() && divisor.asInt() == 0) {
+                    return false;
+                }
+            }
+            [[fallthrough]];
+        }
+        default: {
+            auto& binary = static_cast<const BinaryAST&>(node);
+            return isValue(binary.getLExpr()) && isValue(binary.getRExpr());
+        }
+    }
+}
+
+ConstantFolder::ConstantFolder(Evaluate evaluate) : evaluate(move(evaluate)) {}
+
+unique_ptr<AST> ConstantFolder::fold(const AST& ast) { return transform(ast); }
+
+unique_ptr<AST> ConstantFolder::transform(const AST& node) {
+    auto result = ASTTransformer::transform(node);
+    if (!isConstant(*result)) {
+        return result;
+    }
+    auto value = evaluate(*result);
+    if (holds_alternative<double>(value)) {
+        return make_unique<VALUE>(node.getCodeRef(), std::get<double>(value));
+    } else {
+        return make_unique<VALUE>(node.getCodeRef(), std::get<int64_t>(value));
+    }
+}
+
+} // namespace evaluate
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <variant>
+
+namespace evaluate {
+
+// replaces every subtree without variables by its value.
+// the subtrees are evaluated by the evaluator itself, so folding cannot change a result
+class ConstantFolder : private ASTTransformer {
+    public:
+    using Evaluate = std::function<std::variant<int64_t, double>(const AST&)>;
+
+    private:
+    Evaluate evaluate;
+
+    public:
+    explicit ConstantFolder(Evaluate evaluate);
+    std::unique_ptr<AST> fold(const AST& ast);
+
+    private:
+    std::unique_ptr<AST> transform(const AST& node) override;
+};
+
+} // namespace evaluate
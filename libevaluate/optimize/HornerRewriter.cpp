@@ -0,0 +1,232 @@
+#include "HornerRewriter.hpp"
+#include "Functions.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+using namespace std;
+
+namespace evaluate {
+
+// the terms of a sum and whether they are subtracted
+static void sum(const AST& node, bool negative, vector<pair<const AST*, bool>>& terms) {
+    switch (node.getType()) {
+        case AST::Type::ADD:
+        case AST::Type::MINUS: {
+            auto& binary = static_cast<const BinaryAST&>(node);
+            sum(binary.getLExpr(), negative, terms);
+            sum(binary.getRExpr(), negative != (node.getType() == AST::Type::MINUS), terms);
+            break;
+        }
+        case AST::Type::UnaryMINUS:
+            sum(static_cast<const UnaryAST&>(node).getChild(), !negative, terms);
+            break;
+        default: terms.emplace_back(&node, negative);
+    }
+}
+
+// the factors of a product, a negation flips negative
+static void product(const AST& node, bool& negative, vector<const AST*>& factors) {
+    if (node.getType() == AST::Type::MUL) {
+        auto& binary = static_cast<const BinaryAST&>(node);
+        product(binary.getLExpr(), negative, factors);
+        product(binary.getRExpr(), negative, factors);
+    } else if (node.getType() == AST::Type::UnaryMINUS) {
+        negative = !negative;
+        product(static_cast<const UnaryAST&>(node).getChild(), negative, factors);
+    } else {
+        factors.push_back(&node);
+    }
+}
+
+// a constant integral exponent that is worth unrolling
+static optional<int64_t> exponent(const AST& node) {
+    if (node.getType() != AST::Type::VALUE) {
+        return nullopt;
+    }
+    auto& value = static_cast<const VALUE&>(node);
+    double exponent = value.isFP() ? value.asDouble() : static_cast<double>(value.asInt());
+    if (exponent >= 1 && exponent <= 64 && trunc(exponent) == exponent) {
+        return static_cast<int64_t>(exponent);
+    }
+    return nullopt;
+}
+
+// the base and exponent of x ** k and pow(x, k) for a variable x, otherwise nullopt
+static optional<pair<const VARIABLE*, int64_t>> variablePower(const AST& factor) {
+    const AST* base = nullptr;
+    const AST* k = nullptr;
+    if (factor.getType() == AST::Type::VARIABLE) {
+        return pair(&static_cast<const VARIABLE&>(factor), 1);
+    } else if (factor.getType() == AST::Type::POW) {
+        base = &static_cast<const POW&>(factor).getLExpr();
+        k = &static_cast<const POW&>(factor).getRExpr();
+    } else if (factor.getType() == AST::Type::FUNCTION) {
+        auto& function = static_cast<const FUNCTION&>(factor);
+        if (function.getFunctionType() != FunctionType::pow ||
+            function.getParameters().size() != 2) {
+            return nullopt;
+        }
+        base = function.getParameters()[0].get();
+        k = function.getParameters()[1].get();
+    }
+    if (!base || base->getType() != AST::Type::VARIABLE || !exponent(*k)) {
+        return nullopt;
+    }
+    return pair(static_cast<const VARIABLE*>(base), *exponent(*k));
+}
+
+HornerRewriter::HornerRewriter(vector<Rewrite>& rewrites) : rewrites(rewrites) {}
+
+unique_ptr<AST> HornerRewriter::rewrite(const AST& ast) { return transform(ast); }
+
+vector<HornerRewriter::Monomial>
+HornerRewriter::polynomial(const vector<pair<const AST*, bool>>& terms, size_t x) const {
+    vector<Monomial> monomials{};
+    for (auto [term, negative] : terms) {
+        Monomial monomial{.negative = negative};
+        vector<const AST*> factors{};
+        product(*term, monomial.negative, factors);
+        for (auto factor : factors) {
+            if (auto m = variablePower(*factor); m && m->first->getIndex() == x) {
+                monomial.degree += m->second;
+            } else if (dependsOn(*factor, x)) {
+                return {};
+            } else {
+                monomial.factors.push_back(factor);
+            }
+        }
+        monomials.push_back(move(monomial));
+    }
+    return monomials;
+}
+
+unique_ptr<AST> HornerRewriter::coefficient(span<const Monomial> monomials, const AST& node) {
+    unique_ptr<AST> sum{};
+    for (auto& monomial : monomials) {
+        unique_ptr<AST> product{};
+        for (auto factor : monomial.factors) {
+            auto f = transform(*factor);
+            product = product ? make_unique<MUL>(node.getCodeRef(), move(product), move(f)) :
+                                move(f);
+        }
+        if (!product) {
+            product = make_unique<VALUE>(node.getCodeRef(), int64_t{monomial.negative ? -1 : 1});
+        } else if (monomial.negative) {
+            product = make_unique<UnaryMINUS>(node.getCodeRef(), move(product));
+        }
+        sum = sum ? make_unique<ADD>(node.getCodeRef(), move(sum), move(product)) : move(product);
+    }
+    return sum;
+}
+
+// x ** exponent as multiplications, the two halves of a square are the same expression
+unique_ptr<AST> HornerRewriter::power(const AST& x, int64_t exponent, const AST& node) {
+    if (exponent == 1) {
+        return transform(x);
+    }
+    if (exponent % 2 == 1) {
+        auto l_expr = power(x, exponent - 1, node);
+        return make_unique<MUL>(node.getCodeRef(), move(l_expr), transform(x));
+    }
+    auto l_expr = power(x, exponent / 2, node);
+    auto r_expr = clone(*l_expr);
+    return make_unique<MUL>(node.getCodeRef(), move(l_expr), move(r_expr));
+}
+
+bool HornerRewriter::horner(const AST& node) {
+    vector<pair<const AST*, bool>> terms{};
+    sum(node, false, terms);
+    // only a variable that is squared somewhere can make this a polynomial of degree 2 or more
+    vector<const VARIABLE*> candidates{};
+    for (auto [term, negative] : terms) {
+        vector<const AST*> factors{};
+        product(*term, negative, factors);
+        for (auto factor : factors) {
+            auto m = variablePower(*factor);
+            if (!m || ranges::any_of(candidates, [&](const VARIABLE* x) {
+                    return x->getIndex() == m->first->getIndex();
+                })) {
+                continue;
+            }
+            auto occurrences =
+                ranges::count_if(factors, [&](const AST* f) { return equal(*f, *m->first); });
+            if (m->second >= 2 || occurrences >= 2) {
+                candidates.push_back(m->first);
+            }
+        }
+    }
+    for (auto x : candidates) {
+        auto monomials = polynomial(terms, x->getIndex());
+        if (monomials.empty()) {
+            continue;
+        }
+        ranges::stable_sort(monomials, greater{}, &Monomial::degree);
+        // the monomials of one degree are added to one coefficient
+        vector<size_t> starts{};
+        for (size_t i = 0; i < monomials.size(); ++i) {
+            if (i == 0 || monomials[i].degree != monomials[i - 1].degree) {
+                starts.push_back(i);
+            }
+        }
+        starts.push_back(monomials.size());
+        size_t degrees = starts.size() - 1;
+        auto degree = [&](size_t i) { return i < degrees ? monomials[starts[i]].degree : 0; };
+        auto group = [&](size_t i) {
+            return span(monomials).subspan(starts[i], starts[i + 1] - starts[i]);
+        };
+
+        // every step is a double operation if the leading coefficient or x is a double
+        bool unit = starts[1] == 1 && monomials[0].factors.empty() && !monomials[0].negative;
+        auto acc = unit ? nullptr : coefficient(group(0), node);
+        if (!isDouble(*x) && !(acc && isDouble(*acc))) {
+            continue;
+        }
+        rewrites.push_back({"horner", node.getCodeRef(), FloatPolicy::fast});
+        for (size_t i = 1; i <= degrees; ++i) {
+            if (int64_t gap = degree(i - 1) - degree(i); gap > 0) {
+                auto p = power(*x, gap, node);
+                acc = acc ? make_unique<MUL>(node.getCodeRef(), move(acc), move(p)) : move(p);
+            }
+            if (i < degrees) {
+                acc = make_unique<ADD>(node.getCodeRef(), move(acc), coefficient(group(i), node));
+            }
+        }
+        reg = move(acc);
+        return true;
+    }
+    return false;
+}
+
+unique_ptr<AST> HornerRewriter::rebuild(const AST& node) {
+    switch (node.getType()) {
+        case AST::Type::ADD:
+        case AST::Type::MINUS: {
+            auto& binary = static_cast<const BinaryAST&>(node);
+            auto l_expr = rebuild(binary.getLExpr());
+            auto r_expr = rebuild(binary.getRExpr());
+            if (node.getType() == AST::Type::ADD) {
+                return make_unique<ADD>(node.getCodeRef(), move(l_expr), move(r_expr));
+            }
+            return make_unique<MINUS>(node.getCodeRef(), move(l_expr), move(r_expr));
+        }
+        case AST::Type::UnaryMINUS:
+            return make_unique<UnaryMINUS>(node.getCodeRef(),
+                                           rebuild(static_cast<const UnaryAST&>(node).getChild()));
+        default: return transform(node);
+    }
+}
+
+void HornerRewriter::visit(const ADD& node) {
+    if (!horner(node)) {
+        reg = rebuild(node);
+    }
+}
+void HornerRewriter::visit(const MINUS& node) {
+    if (!horner(node)) {
+        reg = rebuild(node);
+    }
+}
+
+} // namespace evaluate
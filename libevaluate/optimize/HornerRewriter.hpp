@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include "Rewrite.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace evaluate {
+
+// rewrites polynomials in one variable into Horner form,
+// e.g. a * x ** 3 + b * x ** 2 + c * x + d -> ((a * x + b) * x + c) * x + d, which needs no pow
+// and one multiplication and addition per term that the IdiomRewriter fuses into fma.
+// the powers of x that a sparse polynomial skips are built by squaring, so CSE shares them
+// between terms. the rounding changes, so this only runs under FloatPolicy::fast and only for
+// polynomials that are evaluated with doubles
+class HornerRewriter : private ASTTransformer {
+    private:
+    // sign * factors * x ** degree
+    struct Monomial {
+        int64_t degree = 0;
+        bool negative = false;
+        std::vector<const AST*> factors{};
+    };
+
+    std::vector<Rewrite>& rewrites;
+
+    public:
+    explicit HornerRewriter(std::vector<Rewrite>& rewrites);
+    std::unique_ptr<AST> rewrite(const AST& ast);
+
+    private:
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+
+    bool horner(const AST& node);
+    // the polynomial in the variable x, or an empty vector if node is none
+    std::vector<Monomial> polynomial(const std::vector<std::pair<const AST*, bool>>& terms,
+                                     size_t x) const;
+    std::unique_ptr<AST> coefficient(std::span<const Monomial> monomials, const AST& node);
+    std::unique_ptr<AST> power(const AST& x, int64_t exponent, const AST& node);
+    // copies the sum node without looking for polynomials in its parts again
+    std::unique_ptr<AST> rebuild(const AST& node);
+};
+
+} // namespace evaluate
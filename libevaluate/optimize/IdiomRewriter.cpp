@@ -0,0 +1,128 @@
+#include "IdiomRewriter.hpp"
+#include "Functions.hpp"
+
+using namespace std;
+
+namespace evaluate {
+
+static bool isOne(const AST& node) {
+    if (node.getType() != AST::Type::VALUE) {
+        return false;
+    }
+    auto& value = static_cast<const VALUE&>(node);
+    return value.isFP() ? value.asDouble() == 1.0 : value.asInt() == 1;
+}
+
+// x for x * x and x ** 2, otherwise nullptr
+static const AST* squared(const AST& node) {
+    if (node.getType() != AST::Type::MUL && node.getType() != AST::Type::POW) {
+        return nullptr;
+    }
+    auto& binary = static_cast<const BinaryAST&>(node);
+    if (node.getType() == AST::Type::MUL) {
+        return equal(binary.getLExpr(), binary.getRExpr()) ? &binary.getLExpr() : nullptr;
+    }
+    if (binary.getRExpr().getType() == AST::Type::VALUE) {
+        auto& exponent = static_cast<const VALUE&>(binary.getRExpr());
+        if (exponent.isFP() ? exponent.asDouble() == 2.0 : exponent.asInt() == 2) {
+            return &binary.getLExpr();
+        }
+    }
+    return nullptr;
+}
+
+// the single parameter of a call to type, otherwise nullptr
+static const AST* argument(const AST& node, FunctionType type) {
+    if (node.getType() != AST::Type::FUNCTION) {
+        return nullptr;
+    }
+    auto& function = static_cast<const FUNCTION&>(node);
+    if (function.getFunctionType() != type || function.getParameters().size() != 1) {
+        return nullptr;
+    }
+    return function.getParameters()[0].get();
+}
+
+IdiomRewriter::IdiomRewriter(const Options& options, vector<Rewrite>& rewrites)
+    : options(options), rewrites(rewrites) {}
+
+unique_ptr<AST> IdiomRewriter::rewrite(const AST& ast) { return transform(ast); }
+
+void IdiomRewriter::fused(const AST& node, FunctionType type,
+                          vector<unique_ptr<AST>> parameters) {
+    rewrites.push_back({functionName(type), node.getCodeRef(),
+                        type == FunctionType::fma ? FloatPolicy::contract : FloatPolicy::fast});
+    reg = make_unique<FUNCTION>(node.getCodeRef(), type, functionName(type), move(parameters));
+}
+
+// fma of integers would turn an integer result into a double. a product that may be an integer
+// product is not a double multiplication, so only relaxed options compute it with fma
+bool IdiomRewriter::contractible(const AST& sum, const AST& product) const {
+    return isDouble(sum) && (isDouble(product) || options.relaxed());
+}
+
+void IdiomRewriter::visit(const FUNCTION& node) {
+    if (!options.relaxed()) {
+        return ASTTransformer::visit(node);
+    }
+    vector<unique_ptr<AST>> parameters{};
+    if (auto x = argument(node, FunctionType::log); x && x->getType() == AST::Type::ADD) {
+        auto& sum = static_cast<const BinaryAST&>(*x);
+        if (isOne(sum.getLExpr())) {
+            parameters.emplace_back(transform(sum.getRExpr()));
+        } else if (isOne(sum.getRExpr())) {
+            parameters.emplace_back(transform(sum.getLExpr()));
+        }
+        if (!parameters.empty()) {
+            return fused(node, FunctionType::log1p, move(parameters));
+        }
+    }
+    if (auto x = argument(node, FunctionType::sqrt); x && x->getType() == AST::Type::ADD) {
+        auto& sum = static_cast<const BinaryAST&>(*x);
+        auto l = squared(sum.getLExpr()), r = squared(sum.getRExpr());
+        if (l && r) {
+            parameters.emplace_back(transform(*l));
+            parameters.emplace_back(transform(*r));
+            return fused(node, FunctionType::hypot, move(parameters));
+        }
+    }
+    ASTTransformer::visit(node);
+}
+
+void IdiomRewriter::visit(const ADD& node) {
+    auto& l = node.getLExpr();
+    auto& r = node.getRExpr();
+    if (l.getType() == AST::Type::MUL || r.getType() == AST::Type::MUL) {
+        auto& product = static_cast<const BinaryAST&>(l.getType() == AST::Type::MUL ? l : r);
+        auto& addend = l.getType() == AST::Type::MUL ? r : l;
+        if (!contractible(node, product)) {
+            return ASTTransformer::visit(node);
+        }
+        vector<unique_ptr<AST>> parameters{};
+        parameters.emplace_back(transform(product.getLExpr()));
+        parameters.emplace_back(transform(product.getRExpr()));
+        parameters.emplace_back(transform(addend));
+        return fused(node, FunctionType::fma, move(parameters));
+    }
+    ASTTransformer::visit(node);
+}
+
+void IdiomRewriter::visit(const MINUS& node) {
+    auto& l = node.getLExpr();
+    auto& r = node.getRExpr();
+    vector<unique_ptr<AST>> parameters{};
+    if (auto x = argument(l, FunctionType::exp); x && isOne(r) && options.relaxed()) {
+        parameters.emplace_back(transform(*x));
+        return fused(node, FunctionType::expm1, move(parameters));
+    }
+    if (l.getType() == AST::Type::MUL && contractible(node, l)) {
+        auto& product = static_cast<const BinaryAST&>(l);
+        parameters.emplace_back(transform(product.getLExpr()));
+        parameters.emplace_back(transform(product.getRExpr()));
+        parameters.emplace_back(make_unique<UnaryMINUS>(r.getCodeRef(), transform(r)));
+        return fused(node, FunctionType::fma, move(parameters));
+    }
+    ASTTransformer::visit(node);
+}
+
+} // namespace evaluate
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include "Options.hpp"
+#include "Rewrite.hpp"
+#include <memory>
+#include <vector>
+
+namespace evaluate {
+
+// replaces common formulas with their fused functions:
+// log(1 + x) -> log1p(x), exp(x) - 1 -> expm1(x), sqrt(x * x + y * y) -> hypot(x, y)
+// and a * b + c -> fma(a, b, c), a * b - c -> fma(a, b, -c) for doubles.
+// the fused functions round differently, so fma needs options that contract and the others need
+// relaxed options
+class IdiomRewriter : private ASTTransformer {
+    private:
+    const Options& options;
+    std::vector<Rewrite>& rewrites;
+
+    public:
+    IdiomRewriter(const Options& options, std::vector<Rewrite>& rewrites);
+    std::unique_ptr<AST> rewrite(const AST& ast);
+
+    private:
+    void visit(const FUNCTION& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+
+    void fused(const AST& node, FunctionType type, std::vector<std::unique_ptr<AST>> parameters);
+    // whether a * b + c of the product can be fused
+    bool contractible(const AST& sum, const AST& product) const;
+};
+
+} // namespace evaluate
@@ -0,0 +1,40 @@
+#include "PassManager.hpp"
+#include "analyze/ASTPrinter.hpp"
+
+#include <chrono>
+
+using namespace std;
+
+namespace evaluate {
+
+PassManager::PassManager(const Code& code, ostream* dump, vector<PassStatistics>& statistics)
+    : code(code), dump(dump), statistics(statistics) {}
+
+void PassManager::add(string_view name, Pass pass) { passes.emplace_back(name, move(pass)); }
+
+unique_ptr<AST> PassManager::run(unique_ptr<AST> ast) {
+    print("input", *ast);
+    size_t nodes = countNodes(*ast);
+    for (auto& [name, pass] : passes) {
+        auto start = chrono::steady_clock::now();
+        ast = pass(*ast);
+        auto time = chrono::steady_clock::now() - start;
+        size_t after = countNodes(*ast);
+        statistics.push_back({name, chrono::duration_cast<chrono::nanoseconds>(time), nodes, after});
+        nodes = after;
+        print(name, *ast);
+    }
+    return ast;
+}
+
+void PassManager::print(string_view stage, const AST& ast) const {
+    if (!dump) {
+        return;
+    }
+    *dump << "digraph \"" << stage << "\" {" << endl;
+    ASTPrinter printer(code, *dump);
+    ast.accept(printer);
+    *dump << "}" << endl;
+}
+
+} // namespace evaluate
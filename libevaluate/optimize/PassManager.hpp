@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Statistics.hpp"
+#include "analyze/AST.hpp"
+#include "util/Code.hpp"
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace evaluate {
+
+// runs a pipeline of passes over an AST, measures the wall time and the change in the number of
+// nodes of every pass and prints the AST before and after every pass if dump is set
+class PassManager {
+    public:
+    using Pass = std::function<std::unique_ptr<AST>(const AST&)>;
+
+    private:
+    const Code& code;
+    std::ostream* dump;
+    std::vector<PassStatistics>& statistics;
+    std::vector<std::pair<std::string_view, Pass>> passes;
+
+    public:
+    PassManager(const Code& code, std::ostream* dump, std::vector<PassStatistics>& statistics);
+    void add(std::string_view name, Pass pass);
+    std::unique_ptr<AST> run(std::unique_ptr<AST> ast);
+
+    private:
+    void print(std::string_view stage, const AST& ast) const;
+};
+
+} // namespace evaluate
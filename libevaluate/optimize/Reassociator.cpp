@@ -0,0 +1,82 @@
+#include "Reassociator.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace evaluate {
+
+Reassociator::Reassociator(const Options& options, vector<Rewrite>& rewrites)
+    : options(options), rewrites(rewrites) {}
+
+unique_ptr<AST> Reassociator::reassociate(const AST& ast) { return transform(ast); }
+
+void Reassociator::flatten(const AST& node, AST::Type type, vector<const AST*>& operands) const {
+    if (node.getType() != type) {
+        operands.push_back(&node);
+        return;
+    }
+    auto& binary = static_cast<const BinaryAST&>(node);
+    flatten(binary.getLExpr(), type, operands);
+    flatten(binary.getRExpr(), type, operands);
+}
+
+bool Reassociator::reassociable(AST::Type type, span<const AST* const> operands) const {
+    // bitwise operations only have integer results, an operand that is a double is an error
+    // wherever it is in the chain
+    if (type == AST::Type::OR || type == AST::Type::XOR || type == AST::Type::AND) {
+        return true;
+    }
+    // integer addition and multiplication wrap around, so they are associative.
+    // a chain with integer and double operands would convert at a different point
+    if (ranges::all_of(operands, [](const AST* operand) { return isInteger(*operand); })) {
+        return true;
+    }
+    return options.relaxed() &&
+           ranges::all_of(operands, [](const AST* operand) { return isDouble(*operand); });
+}
+
+template <typename ast> unique_ptr<AST> Reassociator::balance(span<const AST* const> operands) {
+    if (operands.size() == 1) {
+        return transform(*operands.front());
+    }
+    size_t middle = operands.size() / 2;
+    auto l_expr = balance<ast>(operands.first(middle));
+    auto r_expr = balance<ast>(operands.subspan(middle));
+    return make_unique<ast>(
+        CodeReference::combine(operands.front()->getCodeRef(), operands.back()->getCodeRef()),
+        move(l_expr), move(r_expr));
+}
+
+// copies the chain as it is without flattening it again for every node
+template <typename ast>
+unique_ptr<AST> Reassociator::rebuild(const AST& node, AST::Type type) {
+    if (node.getType() != type) {
+        return transform(node);
+    }
+    auto& binary = static_cast<const BinaryAST&>(node);
+    auto l_expr = rebuild<ast>(binary.getLExpr(), type);
+    auto r_expr = rebuild<ast>(binary.getRExpr(), type);
+    return make_unique<ast>(node.getCodeRef(), move(l_expr), move(r_expr));
+}
+
+template <typename ast> void Reassociator::visitChain(const ast& node) {
+    vector<const AST*> operands{};
+    flatten(node, node.getType(), operands);
+    // a chain of three operands cannot get shallower
+    if (operands.size() > 3 && reassociable(node.getType(), operands)) {
+        rewrites.push_back({"balance", node.getCodeRef(),
+                            isDouble(node) ? FloatPolicy::fast : FloatPolicy::strict});
+        reg = balance<ast>(operands);
+    } else {
+        reg = rebuild<ast>(node, node.getType());
+    }
+}
+
+void Reassociator::visit(const OR& node) { visitChain(node); }
+void Reassociator::visit(const XOR& node) { visitChain(node); }
+void Reassociator::visit(const AND& node) { visitChain(node); }
+void Reassociator::visit(const ADD& node) { visitChain(node); }
+void Reassociator::visit(const MUL& node) { visitChain(node); }
+
+} // namespace evaluate
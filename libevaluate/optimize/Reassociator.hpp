@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include "Options.hpp"
+#include "Rewrite.hpp"
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace evaluate {
+
+// rebalances chains of an associative operator, e.g. a + b + c + d -> (a + b) + (c + d),
+// so a chain of n operands is log(n) deep and its operations do not wait for each other.
+// the order of the operands is kept. integer chains are always rebalanced, double chains change
+// the rounding and are only rebalanced under FloatPolicy::fast
+class Reassociator : private ASTTransformer {
+    private:
+    const Options& options;
+    std::vector<Rewrite>& rewrites;
+
+    public:
+    Reassociator(const Options& options, std::vector<Rewrite>& rewrites);
+    std::unique_ptr<AST> reassociate(const AST& ast);
+
+    private:
+    void visit(const OR& node) override;
+    void visit(const XOR& node) override;
+    void visit(const AND& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MUL& node) override;
+
+    template <typename ast> void visitChain(const ast& node);
+    // the operands of the chain of node.getType() that starts at node
+    void flatten(const AST& node, AST::Type type, std::vector<const AST*>& operands) const;
+    bool reassociable(AST::Type type, std::span<const AST* const> operands) const;
+    template <typename ast> std::unique_ptr<AST> balance(std::span<const AST* const> operands);
+    template <typename ast> std::unique_ptr<AST> rebuild(const AST& node, AST::Type type);
+};
+
+} // namespace evaluate
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Options.hpp"
+#include "util/Code.hpp"
+#include <string_view>
+
+namespace evaluate {
+
+// a rewrite done by an optimization, for reporting
+struct Rewrite {
+    std::string_view name; // what the code was rewritten to
+    CodeReference codeRef;  // the code that was rewritten
+    FloatPolicy policy = FloatPolicy::strict; // the strictest policy that allows the rewrite
+};
+
+} // namespace evaluate
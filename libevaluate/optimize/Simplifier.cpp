@@ -0,0 +1,219 @@
+#include "Simplifier.hpp"
+#include "Functions.hpp"
+
+#include <bit>
+#include <cmath>
+#include <utility>
+
+using namespace std;
+
+namespace evaluate {
+
+static bool isInt(const AST& node, int64_t value) {
+    return node.getType() == AST::Type::VALUE && !static_cast<const VALUE&>(node).isFP() &&
+           static_cast<const VALUE&>(node).asInt() == value;
+}
+
+// also true for -0.0 when value is 0.0
+static bool isFP(const AST& node, double value) {
+    return node.getType() == AST::Type::VALUE && static_cast<const VALUE&>(node).isFP() &&
+           static_cast<const VALUE&>(node).asDouble() == value;
+}
+
+// k for the integer 2 ** k, otherwise 0
+static int64_t shift(const AST& node) {
+    if (node.getType() != AST::Type::VALUE || static_cast<const VALUE&>(node).isFP()) {
+        return 0;
+    }
+    int64_t value = static_cast<const VALUE&>(node).asInt();
+    return value > 1 && has_single_bit(static_cast<uint64_t>(value)) ?
+               countr_zero(static_cast<uint64_t>(value)) :
+               0;
+}
+
+Simplifier::Simplifier(const Options& options, vector<Rewrite>& rewrites)
+    : options(options), rewrites(rewrites) {}
+
+unique_ptr<AST> Simplifier::simplify(const AST& ast) { return transform(ast); }
+
+void Simplifier::record(const AST& node, string_view name, FloatPolicy policy) {
+    rewrites.push_back({name, node.getCodeRef(), policy});
+}
+
+void Simplifier::identity(const AST& node, const AST& operand, FloatPolicy policy) {
+    record(node, "identity", policy);
+    reg = transform(operand);
+}
+
+const AST* Simplifier::bitwiseIdentity(const BinaryAST& node, int64_t neutral, bool commutative) {
+    auto& l = node.getLExpr();
+    auto& r = node.getRExpr();
+    // a bitwise operation on a double is an error, which must not be simplified away
+    if (isInt(r, neutral) && isInteger(l)) {
+        return &l;
+    }
+    if (commutative && isInt(l, neutral) && isInteger(r)) {
+        return &r;
+    }
+    return nullptr;
+}
+
+bool Simplifier::power(const AST& node, const AST& base, const AST& exponent) {
+    bool fast = options.relaxed();
+    if (isInt(exponent, 1) || (isFP(exponent, 1.0) && isDouble(base))) {
+        identity(node, base);
+        return true;
+    }
+    // an integer square can overflow and be promoted to double, which x * x does not do
+    if (fast && (isInt(exponent, 2) || isFP(exponent, 2.0)) && isDouble(base)) {
+        record(node, "square", FloatPolicy::fast);
+        auto l = transform(base);
+        auto r = transform(base);
+        reg = make_unique<MUL>(node.getCodeRef(), move(l), move(r));
+        return true;
+    }
+    // pow(-0, 0.5) is 0 and pow(-inf, 0.5) is inf, but sqrt gives -0 and nan
+    if (fast && isFP(exponent, 0.5)) {
+        record(node, "sqrt", FloatPolicy::fast);
+        vector<unique_ptr<AST>> parameters{};
+        parameters.emplace_back(transform(base));
+        reg = make_unique<FUNCTION>(node.getCodeRef(), FunctionType::sqrt,
+                                    functionName(FunctionType::sqrt), move(parameters));
+        return true;
+    }
+    return false;
+}
+
+void Simplifier::visit(const FUNCTION& node) {
+    auto& parameters = node.getParameters();
+    if (node.getFunctionType() == FunctionType::pow && parameters.size() == 2 &&
+        power(node, *parameters[0], *parameters[1])) {
+        return;
+    }
+    ASTTransformer::visit(node);
+}
+void Simplifier::visit(const POW& node) {
+    if (!power(node, node.getLExpr(), node.getRExpr())) {
+        ASTTransformer::visit(node);
+    }
+}
+void Simplifier::visit(const OR& node) {
+    if (auto x = bitwiseIdentity(node, 0, true)) {
+        identity(node, *x);
+    } else {
+        ASTTransformer::visit(node);
+    }
+}
+void Simplifier::visit(const XOR& node) {
+    if (auto x = bitwiseIdentity(node, 0, true)) {
+        identity(node, *x);
+    } else {
+        ASTTransformer::visit(node);
+    }
+}
+void Simplifier::visit(const AND& node) {
+    if (auto x = bitwiseIdentity(node, -1, true)) {
+        identity(node, *x);
+    } else {
+        ASTTransformer::visit(node);
+    }
+}
+void Simplifier::visit(const SHL& node) {
+    if (auto x = bitwiseIdentity(node, 0, false)) {
+        identity(node, *x);
+    } else {
+        ASTTransformer::visit(node);
+    }
+}
+void Simplifier::visit(const SHR& node) {
+    if (auto x = bitwiseIdentity(node, 0, false)) {
+        identity(node, *x);
+    } else {
+        ASTTransformer::visit(node);
+    }
+}
+void Simplifier::visit(const ADD& node) {
+    bool fast = options.relaxed();
+    for (auto [x, c] : {pair(&node.getLExpr(), &node.getRExpr()),
+                        pair(&node.getRExpr(), &node.getLExpr())}) {
+        // -0.0 + 0 is 0.0, so only -0.0 is neutral for doubles
+        if (isInt(*c, 0) && isInteger(*x)) {
+            return identity(node, *x);
+        }
+        if (isFP(*c, 0.0) && isDouble(*x) && signbit(static_cast<const VALUE&>(*c).asDouble())) {
+            return identity(node, *x);
+        }
+        if (fast && (isInt(*c, 0) || (isFP(*c, 0.0) && isDouble(*x)))) {
+            return identity(node, *x, FloatPolicy::fast);
+        }
+    }
+    ASTTransformer::visit(node);
+}
+void Simplifier::visit(const MINUS& node) {
+    auto& x = node.getLExpr();
+    auto& c = node.getRExpr();
+    if (isInt(c, 0) ||
+        (isFP(c, 0.0) && isDouble(x) && !signbit(static_cast<const VALUE&>(c).asDouble()))) {
+        return identity(node, x);
+    }
+    if (isFP(c, 0.0) && isDouble(x) && options.relaxed()) {
+        return identity(node, x, FloatPolicy::fast);
+    }
+    ASTTransformer::visit(node);
+}
+void Simplifier::visit(const MUL& node) {
+    for (auto [x, c] : {pair(&node.getLExpr(), &node.getRExpr()),
+                        pair(&node.getRExpr(), &node.getLExpr())}) {
+        if (isInt(*c, 1) || (isFP(*c, 1.0) && isDouble(*x))) {
+            return identity(node, *x);
+        }
+    }
+    for (auto [x, c] : {pair(&node.getLExpr(), &node.getRExpr()),
+                        pair(&node.getRExpr(), &node.getLExpr())}) {
+        if (int64_t k = shift(*c); k != 0 && isInteger(*x)) {
+            record(node, "shift");
+            auto l = transform(*x);
+            auto r = make_unique<VALUE>(c->getCodeRef(), k);
+            reg = make_unique<SHL>(node.getCodeRef(), move(l), move(r));
+            return;
+        }
+    }
+    ASTTransformer::visit(node);
+}
+void Simplifier::visit(const DIV& node) {
+    auto& x = node.getLExpr();
+    auto& c = node.getRExpr();
+    if (isInt(c, 1) || (isFP(c, 1.0) && isDouble(x))) {
+        return identity(node, x);
+    }
+    // the division must be a double division, which an integer divisor only is for a double x
+    auto reciprocal = node.getReciprocal();
+    if (reciprocal && (isDouble(c) || isDouble(x)) &&
+        (node.isExactReciprocal() || options.relaxed())) {
+        record(node, "reciprocal",
+               node.isExactReciprocal() ? FloatPolicy::strict : FloatPolicy::fast);
+        auto l = transform(x);
+        reg = make_unique<MUL>(node.getCodeRef(), move(l),
+                               make_unique<VALUE>(c.getCodeRef(), *reciprocal));
+        return;
+    }
+    ASTTransformer::visit(node);
+}
+void Simplifier::visit(const UnaryMINUS& node) {
+    if (node.getChild().getType() == AST::Type::UnaryMINUS) {
+        return identity(node, static_cast<const UnaryAST&>(node.getChild()).getChild());
+    }
+    ASTTransformer::visit(node);
+}
+void Simplifier::visit(const UnaryPLUS& node) { identity(node, node.getChild()); }
+void Simplifier::visit(const UnaryCOMP& node) {
+    if (node.getChild().getType() == AST::Type::UnaryCOMP) {
+        auto& x = static_cast<const UnaryAST&>(node.getChild()).getChild();
+        if (isInteger(x)) {
+            return identity(node, x);
+        }
+    }
+    ASTTransformer::visit(node);
+}
+
+} // namespace evaluate
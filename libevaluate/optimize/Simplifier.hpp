@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include "Options.hpp"
+#include "Rewrite.hpp"
+#include <memory>
+#include <vector>
+
+namespace evaluate {
+
+// removes operations that do not change the value, e.g. x * 1, x + 0, --x and ~~x,
+// and replaces expensive operations with cheaper ones, e.g. integer x * 8 with x << 3.
+// a rewrite that would turn an integer into a double or the other way round is only done when
+// the type of the operands is known. rewrites that change the IEEE result for some inputs,
+// e.g. x ** 0.5 -> sqrt(x) for -0 and -inf, are only done for relaxed options
+class Simplifier : private ASTTransformer {
+    private:
+    const Options& options;
+    std::vector<Rewrite>& rewrites;
+
+    public:
+    Simplifier(const Options& options, std::vector<Rewrite>& rewrites);
+    std::unique_ptr<AST> simplify(const AST& ast);
+
+    private:
+    void visit(const FUNCTION& node) override;
+    void visit(const POW& node) override;
+    void visit(const OR& node) override;
+    void visit(const XOR& node) override;
+    void visit(const AND& node) override;
+    void visit(const SHL& node) override;
+    void visit(const SHR& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+    void visit(const MUL& node) override;
+    void visit(const DIV& node) override;
+    void visit(const UnaryMINUS& node) override;
+    void visit(const UnaryPLUS& node) override;
+    void visit(const UnaryCOMP& node) override;
+
+    bool power(const AST& node, const AST& base, const AST& exponent);
+    // replaces node by operand
+    void identity(const AST& node, const AST& operand, FloatPolicy policy = FloatPolicy::strict);
+    // x for an integer operation x op neutral or neutral op x, otherwise nullptr
+    const AST* bitwiseIdentity(const BinaryAST& node, int64_t neutral, bool commutative);
+    void record(const AST& node, std::string_view name, FloatPolicy policy = FloatPolicy::strict);
+};
+
+} // namespace evaluate
@@ -0,0 +1,32 @@
+#include "Specializer.hpp"
+
+using namespace std;
+
+namespace evaluate {
+
+Specializer::Specializer(span<const optional<variant<int64_t, double>>> values)
+    : values(values), indices(values.size()) {
+    size_t index = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!values[i]) {
+            indices[i] = index++;
+        }
+    }
+}
+
+unique_ptr<AST> Specializer::specialize(const AST& ast) { return transform(ast); }
+
+void Specializer::visit(const VARIABLE& node) {
+    auto& value = values[node.getIndex()];
+    if (!value) {
+        reg = make_unique<VARIABLE>(node.getCodeRef(), indices[node.getIndex()], node.getName(),
+                                    node.getValueType());
+    } else if (holds_alternative<double>(*value)) {
+        reg = make_unique<VALUE>(node.getCodeRef(), std::get<double>(*value));
+    } else {
+        reg = make_unique<VALUE>(node.getCodeRef(), std::get<int64_t>(*value));
+    }
+}
+void Specializer::visit(const SHARED& node) { reg = transform(node.getExpression()); }
+
+} // namespace evaluate
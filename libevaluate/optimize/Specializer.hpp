@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+namespace evaluate {
+
+// replaces the variables that have a value by that value and renumbers the remaining ones,
+// shared expressions are copied, so they can be folded with the values
+class Specializer : private ASTTransformer {
+    private:
+    std::span<const std::optional<std::variant<int64_t, double>>> values;
+    std::vector<size_t> indices; // the new index of every unbound variable
+
+    public:
+    explicit Specializer(std::span<const std::optional<std::variant<int64_t, double>>> values);
+    std::unique_ptr<AST> specialize(const AST& ast);
+
+    private:
+    void visit(const VARIABLE& node) override;
+    void visit(const SHARED& node) override;
+};
+
+} // namespace evaluate
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace evaluate {
+
+struct SharingStatistics {
+    size_t nodes = 0;        // nodes of the tree before sharing
+    size_t expressions = 0;  // distinct expressions that are shared
+    size_t deduplicated = 0; // nodes that are no longer evaluated more than once
+};
+
+struct PassStatistics {
+    std::string_view name;
+    std::chrono::nanoseconds time{}; // wall time of the pass
+    size_t nodesBefore = 0;          // distinct nodes of the AST the pass got
+    size_t nodesAfter = 0;           // distinct nodes of the AST the pass returned
+};
+
+// the tiers of an expression of Backend::tiered
+struct TierStatistics {
+    uint64_t evaluations = 0;        // evaluations of the expression in every tier
+    uint64_t promotedAfter = 0;      // evaluations until the compilation started, 0 before
+    bool promoted = false;           // whether the compiled tier evaluates the expression
+    std::chrono::nanoseconds time{}; // wall time of the compilation on the background thread
+};
+
+} // namespace evaluate
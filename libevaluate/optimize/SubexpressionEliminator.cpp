@@ -0,0 +1,126 @@
+#include "SubexpressionEliminator.hpp"
+
+#include <bit>
+#include <functional>
+
+using namespace std;
+
+namespace evaluate {
+
+static size_t combine(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+static vector<const AST*> children(const AST& node) {
+    switch (node.getType()) {
+        case AST::Type::VALUE:
+        case AST::Type::VARIABLE: return {};
+        case AST::Type::SHARED: return {&static_cast<const SHARED&>(node).getExpression()};
+        case AST::Type::FUNCTION: {
+            vector<const AST*> parameters{};
+            for (auto& p : static_cast<const FUNCTION&>(node).getParameters()) {
+                parameters.push_back(p.get());
+            }
+            return parameters;
+        }
+        case AST::Type::UnaryMINUS:
+        case AST::Type::UnaryPLUS:
+        case AST::Type::UnaryCOMP: return {&static_cast<const UnaryAST&>(node).getChild()};
+        default: {
+            auto& binary = static_cast<const BinaryAST&>(node);
+            return {&binary.getLExpr(), &binary.getRExpr()};
+        }
+    }
+}
+
+static size_t size(const AST& node) {
+    size_t result = 1;
+    for (auto child : children(node)) {
+        result += size(*child);
+    }
+    return result;
+}
+
+SubexpressionEliminator::SubexpressionEliminator(SharingStatistics& statistics)
+    : statistics(statistics) {}
+
+unique_ptr<AST> SubexpressionEliminator::eliminate(const AST& ast) {
+    statistics.nodes = size(ast);
+    count(ast);
+    return transform(ast);
+}
+
+size_t SubexpressionEliminator::hash(const AST& node) {
+    if (node.getType() == AST::Type::SHARED) {
+        return hash(static_cast<const SHARED&>(node).getExpression());
+    }
+    if (auto it = hashes.find(&node); it != hashes.end()) {
+        return it->second;
+    }
+    size_t result = std::hash<int>()(static_cast<int>(node.getType()));
+    switch (node.getType()) {
+        case AST::Type::VALUE: {
+            auto& value = static_cast<const VALUE&>(node);
+            result = combine(result, value.isFP() ? bit_cast<uint64_t>(value.asDouble()) :
+                                                    static_cast<uint64_t>(value.asInt()));
+            break;
+        }
+        case AST::Type::VARIABLE: {
+            result = combine(result, static_cast<const VARIABLE&>(node).getIndex());
+            break;
+        }
+        case AST::Type::FUNCTION: {
+            auto type = static_cast<const FUNCTION&>(node).getFunctionType();
+            result = combine(result, static_cast<size_t>(type));
+            break;
+        }
+        default: break;
+    }
+    for (auto child : children(node)) {
+        result = combine(result, hash(*child));
+    }
+    hashes[&node] = result;
+    return result;
+}
+
+// counts the occurrences of the expressions that are evaluated once the repeated ones are shared,
+// i.e. without the expressions inside a repeated occurrence
+void SubexpressionEliminator::count(const AST& node) {
+    if (node.getType() == AST::Type::VALUE || node.getType() == AST::Type::VARIABLE) {
+        return;
+    }
+    const AST* first = &node;
+    auto& candidates = classes[hash(node)];
+    for (auto candidate : candidates) {
+        if (equal(*candidate, node)) {
+            first = candidate;
+            break;
+        }
+    }
+    if (first == &node) {
+        candidates.push_back(&node);
+    }
+    representative[&node] = first;
+    if (occurrences[first]++ > 0) {
+        statistics.deduplicated += size(node);
+        return;
+    }
+    for (auto child : children(node)) {
+        count(*child);
+    }
+}
+
+unique_ptr<AST> SubexpressionEliminator::transform(const AST& node) {
+    auto it = representative.find(&node);
+    if (it == representative.end() || occurrences[it->second] < 2) {
+        return ASTTransformer::transform(node);
+    }
+    auto& expression = shared[it->second];
+    if (!expression) {
+        expression = ASTTransformer::transform(node);
+        indices[it->second] = statistics.expressions++;
+    }
+    return make_unique<SHARED>(node.getCodeRef(), indices[it->second], expression);
+}
+
+} // namespace evaluate
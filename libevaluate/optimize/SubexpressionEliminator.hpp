@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ASTTransformer.hpp"
+#include "Statistics.hpp"
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace evaluate {
+
+// turns the AST into a DAG by hash consing: every expression that occurs more than once
+// is replaced by SHARED nodes referring to a single copy, which is evaluated once.
+// values and variables are cheaper to evaluate than to share, so they are never shared
+class SubexpressionEliminator : private ASTTransformer {
+    private:
+    SharingStatistics& statistics;
+    std::unordered_map<const AST*, size_t> hashes;
+    std::unordered_map<size_t, std::vector<const AST*>> classes; // representatives by hash
+    std::unordered_map<const AST*, const AST*> representative;
+    std::unordered_map<const AST*, size_t> occurrences; // by representative
+    std::unordered_map<const AST*, std::shared_ptr<const AST>> shared;
+    std::unordered_map<const AST*, size_t> indices;
+
+    public:
+    explicit SubexpressionEliminator(SharingStatistics& statistics);
+    std::unique_ptr<AST> eliminate(const AST& ast);
+
+    private:
+    std::unique_ptr<AST> transform(const AST& node) override;
+
+    size_t hash(const AST& node);
+    void count(const AST& node);
+};
+
+} // namespace evaluate
@@ -30,6 +30,11 @@ void Literal::accept(NodeVisitor& visitor) const { visitor.visit(*this); }
 double Literal::asDouble() const { return get<double>(value); }
 int64_t Literal::asInt() const { return get<int64_t>(value); }
 
+Variable::Variable(CodeReference codeRef, std::string_view name)
+    : Node(Node::Type::Variable, codeRef), name(name) {}
+string_view Variable::getName() const { return name; }
+void Variable::accept(NodeVisitor& visitor) const { visitor.visit(*this); }
+
 Function::Function(CodeReference codeRef, std::string_view name, std::unique_ptr<Node> l,
                    std::vector<std::unique_ptr<Node>>&& parameters, std::unique_ptr<Node> r)
     : Node(Node::Type::Function, codeRef), name(name), l(move(l)), parameters(move(parameters)),
@@ -17,6 +17,7 @@ class Node {
     enum class Type {
         GenericToken,
         Literal,
+        Variable,
         Function,
         Primary,
         Unary,
@@ -70,6 +71,17 @@ class Literal : public Node {
     bool isFP() const;
 };
 
+class Variable : public Node {
+    private:
+    std::string_view name;
+
+    public:
+    Variable(CodeReference codeRef, std::string_view name);
+    void accept(NodeVisitor& visitor) const override;
+
+    std::string_view getName() const;
+};
+
 class Function : public Node {
     private:
     std::string_view name;
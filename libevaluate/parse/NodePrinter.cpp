@@ -16,6 +16,10 @@ void NodePrinter::visit(const Literal& node) {
     cout << count << " [label=\"Literal: " << node.getCode() << "\"]" << endl;
 }
 
+void NodePrinter::visit(const Variable& node) {
+    cout << count << " [label=\"Variable: " << node.getName() << "\"]" << endl;
+}
+
 void NodePrinter::visit(const Function& node) {
     size_t id = count;
     cout << count << " [label=\"Function: " << node.getName() << "\"]" << endl;
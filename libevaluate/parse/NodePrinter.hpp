@@ -21,6 +21,8 @@ class NodePrinter : public NodeVisitor {
 
     void visit(const Literal& node) override;
 
+    void visit(const Variable& node) override;
+
     void visit(const Function& node) override;
 
     void visit(const Primary& node) override;
@@ -3,6 +3,7 @@
 namespace evaluate {
     class GenericToken;
     class Literal;
+    class Variable;
     class Function;
     class Primary;
     class Unary;
@@ -19,6 +20,7 @@ namespace evaluate {
         virtual ~NodeVisitor() noexcept = default;
         virtual void visit(const GenericToken& node) = 0;
         virtual void visit(const Literal& node) = 0;
+        virtual void visit(const Variable& node) = 0;
         virtual void visit(const Function& node) = 0;
         virtual void visit(const Primary& node) = 0;
         virtual void visit(const Unary& node) = 0;
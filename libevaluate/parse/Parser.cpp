@@ -1,6 +1,7 @@
 #include "Parser.hpp"
 #include "Node.hpp"
 #include "util/Error.hpp"
+#include <algorithm>
 #include <cerrno>
 #include <charconv>
 #include <cstdlib>
@@ -37,6 +38,7 @@ unique_ptr<Node> Parser::parseLiteral() {
             // auto resultD = from_chars(token.getCode().begin(), token.getCode().end(), valueD);
             string str = string(token.getCode());
             char* end;
+            errno = 0; // may still be set by an evaluation
             double valueD = strtod(str.c_str(), &end);
             if (errno == ERANGE) {
                 error(token.getCodeRef().getFrom(), token.getCode().size(), code,
@@ -123,6 +125,10 @@ unique_ptr<Node> Parser::parsePrimary() {
             reg.emplace(token);
             return parseFunction();
         }
+        case Token::Type::VARIABLE: {
+            return make_unique<Primary>(token.getCodeRef(),
+                                        make_unique<Variable>(token.getCodeRef(), token.getCode()));
+        }
         default: {
             error(token.getCodeRef().getFrom(), token.getCode().size(), code,
                   "Syntax Error: unexpected Token, should be: primary expression");
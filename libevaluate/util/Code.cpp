@@ -40,6 +40,9 @@ namespace evaluate {
     }
 
     std::string_view CodeReference::str() const {
+        if (code.empty()) {
+            return {};
+        }
         return code.substr(from, to - from);
     }
 
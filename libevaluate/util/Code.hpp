@@ -14,6 +14,7 @@ namespace evaluate {
         const std::string_view code;
 
     public:
+        // without code, str() is empty and only the offsets remain
         CodeReference(size_t from, size_t to, std::string_view code);
 
         size_t getFrom() const;
@@ -14,6 +14,12 @@ namespace evaluate {
         exit(1);
     }
 
+    void error(size_t offset, size_t size, const std::string& msg) {
+        std::cerr << "Error at offset: " << offset << " with length: " << size << std::endl;
+        std::cerr << "***" << msg << std::endl;
+        exit(1);
+    }
+
     void error(const std::string& msg) {
         std::cerr << msg << std::endl;
         exit(1);
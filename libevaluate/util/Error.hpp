@@ -8,6 +8,8 @@ namespace evaluate {
     class Code;
 
     [[noreturn]] void error(size_t offset, size_t size, const Code& code, const std::string& msg);
+    // for an expression whose source is not retained
+    [[noreturn]] void error(size_t offset, size_t size, const std::string& msg);
     [[noreturn]] void error(const std::string& msg);
 
 } // namespace evaluate
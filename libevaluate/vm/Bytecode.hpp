@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Functions.hpp"
+#include "ValueType.hpp"
+#include "math/Integer.hpp"
+#include <cstdint>
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace evaluate {
+
+// the opcodes of the bytecode, _int and _double operate on registers whose type is known when the
+// expression is compiled, _any checks the types of its operands like the tree-walking evaluator
+#define EVALUATE_OPCODES(X)                                                                        \
+    X(move)                                                                                        \
+    X(to_double)                                                                                   \
+    X(check_int)                                                                                   \
+    X(add_int)                                                                                     \
+    X(sub_int)                                                                                     \
+    X(mul_int)                                                                                     \
+    X(div_int)                                                                                     \
+    X(div_const_int)                                                                               \
+    X(mod_int)                                                                                     \
+    X(mod_const_int)                                                                               \
+    X(neg_int)                                                                                     \
+    X(or_int)                                                                                      \
+    X(xor_int)                                                                                     \
+    X(and_int)                                                                                     \
+    X(shl_int)                                                                                     \
+    X(shr_int)                                                                                     \
+    X(comp_int)                                                                                    \
+    X(add_double)                                                                                  \
+    X(sub_double)                                                                                  \
+    X(mul_double)                                                                                  \
+    X(div_double)                                                                                  \
+    X(mod_double)                                                                                  \
+    X(neg_double)                                                                                  \
+    X(pow_double)                                                                                  \
+    X(call_double)                                                                                 \
+    X(add_any)                                                                                     \
+    X(sub_any)                                                                                     \
+    X(mul_any)                                                                                     \
+    X(div_any)                                                                                     \
+    X(mod_any)                                                                                     \
+    X(neg_any)                                                                                     \
+    X(pow_any)                                                                                     \
+    X(call_any)                                                                                    \
+    X(ret)
+
+enum class Opcode : uint8_t {
+#define EVALUATE_OPCODE(name) name,
+    EVALUATE_OPCODES(EVALUATE_OPCODE)
+#undef EVALUATE_OPCODE
+};
+
+// what an instruction takes from the AST node it was compiled from, so a program does not refer
+// to the AST or the source: constant divisors, integer powers and the parameters of a call
+struct Site {
+    std::optional<SignedDivisor> divisor{}; // for a constant integer divisor
+    std::optional<double> reciprocal{};     // multiplies by it instead of dividing
+    IntegerPower integerPower = nullptr;    // for a constant integer exponent
+    uint8_t parameters = 0;                 // of a call
+    bool floating = false;                  // a call with double parameters and a double result
+};
+
+// where the node of a site is in the source, for the location of an evaluation error
+struct Location {
+    uint32_t offset = 0;
+    uint32_t size = 0;
+};
+
+// dst = a op b, the calls take up to three parameters a, b and c.
+// site is the index of the Site of the instructions that need one or can fail
+struct Instruction {
+    Opcode op;
+    FunctionType function{};
+    uint32_t dst = 0;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
+    uint32_t site = 0;
+};
+
+// a value of a register together with its tag, fp tells which member holds the value
+struct Value {
+    union {
+        int64_t i = 0;
+        double f;
+    };
+    bool fp = false;
+
+    Value() = default;
+    explicit Value(int64_t i) : i(i) {}
+    explicit Value(double f) : f(f), fp(true) {}
+    explicit Value(std::variant<int64_t, double> value) {
+        if (std::holds_alternative<double>(value)) {
+            *this = Value(std::get<double>(value));
+        } else {
+            *this = Value(std::get<int64_t>(value));
+        }
+    }
+
+    double asDouble() const { return fp ? f : static_cast<double>(i); }
+    std::variant<int64_t, double> get() const {
+        return fp ? std::variant<int64_t, double>(f) : std::variant<int64_t, double>(i);
+    }
+};
+
+// a register of the VM holds the value of a Value, its tag is kept apart: the registers of a
+// program are followed by one tag byte per register, 9 instead of 16 bytes per register
+union Register {
+    int64_t i;
+    double f;
+};
+static_assert(sizeof(Register) == 8);
+
+// the registers are laid out as the variables, the shared expressions, the temporaries and the
+// constant pool. registers holds their initial values, so the constants are loaded only once
+struct Program {
+    std::vector<Instruction> instructions;
+    std::vector<Value> registers;
+    std::vector<ValueType> types; // of the variables
+    std::vector<Site> sites;
+    std::vector<Location> locations; // of the sites, empty if the source is not retained
+};
+
+} // namespace evaluate
@@ -0,0 +1,254 @@
+#include "Compiler.hpp"
+#include "analyze/AST.hpp"
+#include "math/VectorMath.hpp"
+
+#include <algorithm>
+#include <bit>
+
+using namespace std;
+
+namespace evaluate {
+
+// constants are numbered separately while compiling, since they follow the temporaries
+static constexpr uint32_t constantBit = 1u << 31;
+
+Compiler::Compiler(const Options& options, span<const ValueType> types, size_t shared)
+    : options(options), types(types), compiled(shared) {}
+
+Program Compiler::compile(const AST& ast) {
+    uint32_t result = operand(ast);
+    emit({Opcode::ret, {}, 0, result});
+    auto base = static_cast<uint32_t>(types.size() + compiled.size()) + maxTemporaries;
+    auto place = [base](uint32_t& r) {
+        if (r & constantBit) {
+            r = base + (r & ~constantBit);
+        }
+    };
+    for (auto& instruction : instructions) {
+        place(instruction.dst);
+        place(instruction.a);
+        place(instruction.b);
+        place(instruction.c);
+    }
+    Program program;
+    program.instructions = move(instructions);
+    program.registers.resize(base);
+    program.registers.insert(program.registers.end(), constants.begin(), constants.end());
+    program.types.assign(types.begin(), types.end());
+    program.sites = move(sites);
+    if (options.retain != Retain::none) {
+        program.locations = move(locations);
+    }
+    return program;
+}
+
+uint32_t Compiler::operand(const AST& node) {
+    node.accept(*this);
+    return reg;
+}
+uint32_t Compiler::doubleOperand(const AST& node) {
+    if (node.getType() == AST::Type::VALUE) {
+        auto& value = static_cast<const VALUE&>(node);
+        return constant(Value(value.isFP() ? value.asDouble() :
+                                             static_cast<double>(value.asInt())));
+    }
+    uint32_t r = operand(node);
+    if (node.getValueType() == ValueType::floating) {
+        return r;
+    }
+    uint32_t converted = temporary();
+    emit({Opcode::to_double, {}, converted, r});
+    return converted;
+}
+uint32_t Compiler::constant(Value value) {
+    pair key(value.fp, value.fp ? bit_cast<int64_t>(value.f) : value.i);
+    auto [it, inserted] = pool.emplace(key, static_cast<uint32_t>(constants.size()));
+    if (inserted) {
+        constants.push_back(value);
+    }
+    return it->second | constantBit;
+}
+uint32_t Compiler::temporary() {
+    maxTemporaries = max(maxTemporaries, temporaries + 1);
+    return static_cast<uint32_t>(types.size() + compiled.size()) + temporaries++;
+}
+uint32_t Compiler::site(const AST& node, Site site) {
+    sites.push_back(site);
+    locations.push_back({static_cast<uint32_t>(node.getCodeRef().getFrom()),
+                         static_cast<uint32_t>(node.getCode().size())});
+    return static_cast<uint32_t>(sites.size() - 1);
+}
+void Compiler::emit(const Instruction& instruction) { instructions.push_back(instruction); }
+
+void Compiler::visit(const evaluate::VALUE& node) {
+    reg = constant(node.isFP() ? Value(node.asDouble()) : Value(node.asInt()));
+}
+void Compiler::visit(const evaluate::VARIABLE& node) {
+    reg = static_cast<uint32_t>(node.getIndex());
+}
+void Compiler::visit(const evaluate::FUNCTION& node) {
+    auto type = node.getFunctionType();
+    auto& parameters = node.getParameters();
+    bool kernel = node.getValueType() == ValueType::floating &&
+                  simd::hasKernel(type, options.accuracy) && parameters.size() <= 3;
+    // no function has more than three parameters
+    array<uint32_t, 3> params{};
+    auto mark = temporaries;
+    for (size_t i = 0; i < parameters.size() && i < params.size(); ++i) {
+        params[i] = kernel ? doubleOperand(*parameters[i]) : operand(*parameters[i]);
+    }
+    temporaries = mark;
+    reg = temporary();
+    bool floating = node.getValueType() == ValueType::floating &&
+                    all_of(parameters.begin(), parameters.end(), [](auto& parameter) {
+                        return parameter->getValueType() == ValueType::floating;
+                    });
+    auto count = static_cast<uint8_t>(min(parameters.size(), params.size()));
+    emit({kernel ? Opcode::call_double : Opcode::call_any, type, reg, params[0], params[1],
+          params[2], site(node, {.parameters = count, .floating = floating})});
+}
+void Compiler::visit(const evaluate::POW& node) {
+    visitArithmetic(node, Opcode::pow_any, Opcode::pow_double, Opcode::pow_any,
+                    {.integerPower = node.getIntegerPower()});
+}
+
+void Compiler::visitArithmetic(const BinaryAST& node, Opcode intOp, Opcode doubleOp, Opcode anyOp,
+                               const Site& site) {
+    auto mark = temporaries;
+    uint32_t l, r;
+    Opcode op;
+    switch (node.getValueType()) {
+        case ValueType::integer:
+            l = operand(node.getLExpr());
+            r = operand(node.getRExpr());
+            op = intOp;
+            break;
+        case ValueType::floating:
+            l = doubleOperand(node.getLExpr());
+            r = doubleOperand(node.getRExpr());
+            op = doubleOp;
+            break;
+        default:
+            l = operand(node.getLExpr());
+            r = operand(node.getRExpr());
+            op = anyOp;
+    }
+    temporaries = mark;
+    reg = temporary();
+    // only the instructions that check the types of their operands use the site
+    bool checked = op == Opcode::div_any || op == Opcode::mod_any || op == Opcode::pow_any;
+    emit({op, {}, reg, l, r, 0, checked ? this->site(node, site) : 0});
+}
+// operands without a known type are checked after both are evaluated, like the tree does
+void Compiler::visitBitwise(const BinaryAST& node, Opcode op) {
+    auto mark = temporaries;
+    uint32_t l = operand(node.getLExpr());
+    uint32_t r = operand(node.getRExpr());
+    if (node.getLExpr().getValueType() != ValueType::integer ||
+        node.getRExpr().getValueType() != ValueType::integer) {
+        uint32_t at = site(node);
+        emit({Opcode::check_int, {}, 0, l, 0, 0, at});
+        emit({Opcode::check_int, {}, 0, r, 0, 0, at});
+    }
+    temporaries = mark;
+    reg = temporary();
+    emit({op, {}, reg, l, r});
+}
+
+void Compiler::visit(const evaluate::OR& node) { visitBitwise(node, Opcode::or_int); }
+void Compiler::visit(const evaluate::XOR& node) { visitBitwise(node, Opcode::xor_int); }
+void Compiler::visit(const evaluate::AND& node) { visitBitwise(node, Opcode::and_int); }
+void Compiler::visit(const evaluate::SHL& node) { visitBitwise(node, Opcode::shl_int); }
+void Compiler::visit(const evaluate::SHR& node) { visitBitwise(node, Opcode::shr_int); }
+void Compiler::visit(const evaluate::ADD& node) {
+    visitArithmetic(node, Opcode::add_int, Opcode::add_double, Opcode::add_any);
+}
+void Compiler::visit(const evaluate::MINUS& node) {
+    visitArithmetic(node, Opcode::sub_int, Opcode::sub_double, Opcode::sub_any);
+}
+void Compiler::visit(const evaluate::MUL& node) {
+    visitArithmetic(node, Opcode::mul_int, Opcode::mul_double, Opcode::mul_any);
+}
+// a constant divisor is only needed by the instruction, not as an operand
+void Compiler::visit(const evaluate::DIV& node) {
+    auto reciprocal = node.getReciprocal();
+    bool multiply = reciprocal && (node.isExactReciprocal() || options.relaxed());
+    if (node.getValueType() == ValueType::integer && node.getDivisor()) {
+        auto mark = temporaries;
+        uint32_t l = operand(node.getLExpr());
+        temporaries = mark;
+        reg = temporary();
+        uint32_t at = site(node, {.divisor = node.getDivisor()});
+        emit({Opcode::div_const_int, {}, reg, l, 0, 0, at});
+    } else if (node.getValueType() == ValueType::floating && multiply) {
+        auto mark = temporaries;
+        uint32_t l = doubleOperand(node.getLExpr());
+        temporaries = mark;
+        reg = temporary();
+        emit({Opcode::mul_double, {}, reg, l, constant(Value(*reciprocal))});
+    } else {
+        Site site{.divisor = node.getDivisor(), .reciprocal = multiply ? reciprocal : nullopt};
+        visitArithmetic(node, Opcode::div_int, Opcode::div_double, Opcode::div_any, site);
+    }
+}
+void Compiler::visit(const evaluate::MOD& node) {
+    if (node.getValueType() == ValueType::integer && node.getDivisor()) {
+        auto mark = temporaries;
+        uint32_t l = operand(node.getLExpr());
+        temporaries = mark;
+        reg = temporary();
+        uint32_t at = site(node, {.divisor = node.getDivisor()});
+        emit({Opcode::mod_const_int, {}, reg, l, 0, 0, at});
+    } else {
+        visitArithmetic(node, Opcode::mod_int, Opcode::mod_double, Opcode::mod_any,
+                        {.divisor = node.getDivisor()});
+    }
+}
+void Compiler::visit(const evaluate::UnaryMINUS& node) {
+    auto mark = temporaries;
+    uint32_t child;
+    Opcode op;
+    switch (node.getValueType()) {
+        case ValueType::integer:
+            child = operand(node.getChild());
+            op = Opcode::neg_int;
+            break;
+        case ValueType::floating:
+            child = doubleOperand(node.getChild());
+            op = Opcode::neg_double;
+            break;
+        default:
+            child = operand(node.getChild());
+            op = Opcode::neg_any;
+    }
+    temporaries = mark;
+    reg = temporary();
+    emit({op, {}, reg, child});
+}
+// the child has the same type, so its register is the result
+void Compiler::visit(const evaluate::UnaryPLUS& node) { node.getChild().accept(*this); }
+void Compiler::visit(const evaluate::UnaryCOMP& node) {
+    auto mark = temporaries;
+    uint32_t child = operand(node.getChild());
+    if (node.getChild().getValueType() != ValueType::integer) {
+        emit({Opcode::check_int, {}, 0, child, 0, 0, site(node)});
+    }
+    temporaries = mark;
+    reg = temporary();
+    emit({Opcode::comp_int, {}, reg, child});
+}
+// the code has no branches, so the first occurrence of a shared expression is always evaluated
+// before the others, which only read its register
+void Compiler::visit(const evaluate::SHARED& node) {
+    auto target = static_cast<uint32_t>(types.size() + node.getIndex());
+    if (!compiled[node.getIndex()]) {
+        auto mark = temporaries;
+        uint32_t r = operand(node.getExpression());
+        temporaries = mark;
+        emit({Opcode::move, {}, target, r});
+        compiled[node.getIndex()] = true;
+    }
+    reg = target;
+}
+
+} // namespace evaluate
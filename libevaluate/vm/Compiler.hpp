@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "Options.hpp"
+#include "analyze/ASTVisitor.hpp"
+#include <cstdint>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace evaluate {
+class AST;
+class BinaryAST;
+
+// compiles an AST into register bytecode that evaluates the nodes in the same order as the
+// tree-walking evaluator. every node gets the register of its result, variables, shared
+// expressions and constants have their own registers, the temporaries are reused like a stack.
+// the program keeps no reference to the AST, the locations of its sites only with
+// Retain::source or Retain::offsets
+class Compiler : private ASTVisitor {
+    private:
+    const Options& options;
+    std::span<const ValueType> types;
+    std::vector<Instruction> instructions;
+    std::vector<Value> constants;
+    std::vector<Site> sites;
+    std::vector<Location> locations;
+    std::map<std::pair<bool, int64_t>, uint32_t> pool; // the index of every constant
+    std::vector<bool> compiled;                         // whether a shared expression has a value
+    uint32_t temporaries = 0;                           // temporaries in use
+    uint32_t maxTemporaries = 0;
+    uint32_t reg = 0; // register with the result of the visited node
+
+    public:
+    // shared is the number of shared expressions
+    Compiler(const Options& options, std::span<const ValueType> types, size_t shared);
+    Program compile(const AST& ast);
+
+    private:
+    void visit(const VALUE& node) override;
+    void visit(const VARIABLE& node) override;
+    void visit(const FUNCTION& node) override;
+    void visit(const POW& node) override;
+    void visit(const OR& node) override;
+    void visit(const XOR& node) override;
+    void visit(const AND& node) override;
+    void visit(const SHL& node) override;
+    void visit(const SHR& node) override;
+    void visit(const ADD& node) override;
+    void visit(const MINUS& node) override;
+    void visit(const MUL& node) override;
+    void visit(const DIV& node) override;
+    void visit(const MOD& node) override;
+    void visit(const UnaryMINUS& node) override;
+    void visit(const UnaryPLUS& node) override;
+    void visit(const UnaryCOMP& node) override;
+    void visit(const SHARED& node) override;
+
+    uint32_t operand(const AST& node);
+    // the register of node converted to double
+    uint32_t doubleOperand(const AST& node);
+    uint32_t constant(Value value);
+    uint32_t temporary();
+    // the index of a new site of node
+    uint32_t site(const AST& node, Site site = {});
+    void emit(const Instruction& instruction);
+
+    // site is the Site of the instructions that check the types of their operands
+    void visitArithmetic(const BinaryAST& node, Opcode intOp, Opcode doubleOp, Opcode anyOp,
+                         const Site& site = {});
+    void visitBitwise(const BinaryAST& node, Opcode op);
+};
+
+} // namespace evaluate
@@ -0,0 +1,376 @@
+#include "JIT.hpp"
+#include "VM.hpp"
+#include "math/VectorMath.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#if defined(__x86_64__) && __has_include(<sys/mman.h>)
+#define EVALUATE_JIT
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+namespace evaluate {
+
+#ifdef EVALUATE_JIT
+
+namespace {
+
+enum : uint8_t { rax = 0, rcx = 1, rdx = 2, xmm0 = 0, xmm1 = 1 };
+
+// emits the few x86-64 instructions the JIT needs, all of them address the registers of the VM
+// as [rbx + disp32], the tags follow the registers
+class Assembler {
+    private:
+    vector<uint8_t> code;
+    uint32_t tags; // offset of the tags
+
+    public:
+    explicit Assembler(size_t registers)
+        : tags(static_cast<uint32_t>(registers * sizeof(Register))) {}
+    const vector<uint8_t>& getCode() const { return code; }
+
+    void bytes(initializer_list<uint8_t> values) { code.insert(code.end(), values); }
+    void imm8(uint8_t value) { code.push_back(value); }
+    void imm32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    void imm64(uint64_t value) {
+        imm32(static_cast<uint32_t>(value));
+        imm32(static_cast<uint32_t>(value >> 32));
+    }
+    // an instruction whose r/m operand is the VM register at index, reg is the other operand or
+    // the opcode extension
+    void memory(initializer_list<uint8_t> opcode, uint8_t reg, uint32_t index) {
+        address(opcode, reg, index * static_cast<uint32_t>(sizeof(Register)));
+    }
+    // the same for the tag of the register at index
+    void tagMemory(initializer_list<uint8_t> opcode, uint8_t reg, uint32_t index) {
+        address(opcode, reg, tags + index);
+    }
+    // a short jump whose target is bound later
+    size_t jump(uint8_t opcode) {
+        bytes({opcode, 0});
+        return code.size();
+    }
+    void bind(size_t jump) { code[jump - 1] = static_cast<uint8_t>(code.size() - jump); }
+
+    void loadInt(uint8_t reg, uint32_t index) { memory({0x48, 0x8B}, reg, index); }
+    void storeInt(uint32_t index, uint8_t reg = rax) {
+        memory({0x48, 0x89}, reg, index);
+        tag(index, false);
+    }
+    void loadDouble(uint8_t xmm, uint32_t index) { memory({0xF2, 0x0F, 0x10}, xmm, index); }
+    void storeDouble(uint32_t index) {
+        memory({0xF2, 0x0F, 0x11}, xmm0, index);
+        tag(index, true);
+    }
+    void tag(uint32_t index, bool fp) {
+        tagMemory({0xC6}, 0, index);
+        imm8(fp);
+    }
+    // cmp byte [tag of index], 0
+    void testDouble(uint32_t index) {
+        tagMemory({0x80}, 7, index);
+        imm8(0);
+    }
+    // the register as double, whatever it holds
+    void convertDouble(uint8_t xmm, uint32_t index) {
+        testDouble(index);
+        size_t notDouble = jump(0x74);
+        loadDouble(xmm, index);
+        size_t done = jump(0xEB);
+        bind(notDouble);
+        memory({0xF2, 0x48, 0x0F, 0x2A}, xmm, index);
+        bind(done);
+    }
+    void call(const void* function) {
+        bytes({0x48, 0xB8});
+        imm64(reinterpret_cast<uintptr_t>(function));
+        bytes({0xFF, 0xD0});
+    }
+
+    private:
+    void address(initializer_list<uint8_t> opcode, uint8_t reg, uint32_t displacement) {
+        bytes(opcode);
+        imm8(static_cast<uint8_t>(0x83 | reg << 3));
+        imm32(displacement);
+    }
+};
+
+// the functions of isCmathFunction
+double (*unary(FunctionType type))(double) {
+    switch (type) {
+        case FunctionType::abs: return [](double x) { return std::fabs(x); };
+        case FunctionType::exp: return [](double x) { return std::exp(x); };
+        case FunctionType::exp2: return [](double x) { return std::exp2(x); };
+        case FunctionType::expm1: return [](double x) { return std::expm1(x); };
+        case FunctionType::log: return [](double x) { return std::log(x); };
+        case FunctionType::log10: return [](double x) { return std::log10(x); };
+        case FunctionType::log2: return [](double x) { return std::log2(x); };
+        case FunctionType::log1p: return [](double x) { return std::log1p(x); };
+        case FunctionType::sqrt: return [](double x) { return std::sqrt(x); };
+        case FunctionType::cbrt: return [](double x) { return std::cbrt(x); };
+        case FunctionType::sin: return [](double x) { return std::sin(x); };
+        case FunctionType::cos: return [](double x) { return std::cos(x); };
+        case FunctionType::tan: return [](double x) { return std::tan(x); };
+        case FunctionType::asin: return [](double x) { return std::asin(x); };
+        case FunctionType::acos: return [](double x) { return std::acos(x); };
+        case FunctionType::atan: return [](double x) { return std::atan(x); };
+        case FunctionType::sinh: return [](double x) { return std::sinh(x); };
+        case FunctionType::cosh: return [](double x) { return std::cosh(x); };
+        case FunctionType::tanh: return [](double x) { return std::tanh(x); };
+        case FunctionType::asinh: return [](double x) { return std::asinh(x); };
+        case FunctionType::acosh: return [](double x) { return std::acosh(x); };
+        case FunctionType::atanh: return [](double x) { return std::atanh(x); };
+        case FunctionType::erf: return [](double x) { return std::erf(x); };
+        case FunctionType::erfc: return [](double x) { return std::erfc(x); };
+        case FunctionType::tgamma: return [](double x) { return std::tgamma(x); };
+        case FunctionType::lgamma: return [](double x) { return std::lgamma(x); };
+        case FunctionType::ceil: return [](double x) { return std::ceil(x); };
+        case FunctionType::floor: return [](double x) { return std::floor(x); };
+        case FunctionType::trunc: return [](double x) { return std::trunc(x); };
+        case FunctionType::round: return [](double x) { return std::round(x); };
+        case FunctionType::nearbyint: return [](double x) { return std::nearbyint(x); };
+        case FunctionType::rint: return [](double x) { return std::rint(x); };
+        case FunctionType::logb: return [](double x) { return std::logb(x); };
+        default: return nullptr;
+    }
+}
+double (*binary(FunctionType type))(double, double) {
+    switch (type) {
+        case FunctionType::fmod: return [](double x, double y) { return std::fmod(x, y); };
+        case FunctionType::remainder:
+            return [](double x, double y) { return std::remainder(x, y); };
+        case FunctionType::fmax: return [](double x, double y) { return std::fmax(x, y); };
+        case FunctionType::fmin: return [](double x, double y) { return std::fmin(x, y); };
+        case FunctionType::fdim: return [](double x, double y) { return std::fdim(x, y); };
+        case FunctionType::pow: return [](double x, double y) { return std::pow(x, y); };
+        case FunctionType::hypot: return [](double x, double y) { return std::hypot(x, y); };
+        case FunctionType::atan2: return [](double x, double y) { return std::atan2(x, y); };
+        case FunctionType::nextafter:
+            return [](double x, double y) { return std::nextafter(x, y); };
+        case FunctionType::copysign:
+            return [](double x, double y) { return std::copysign(x, y); };
+        default: return nullptr;
+    }
+}
+
+// the instructions without machine code of their own
+void step(const VM* vm, const Instruction* instruction, Register* registers) {
+    vm->execute(*instruction, registers);
+}
+
+class Generator {
+    private:
+    const VM& vm;
+    const Options& options;
+    Assembler assembler;
+
+    public:
+    explicit Generator(const VM& vm)
+        : vm(vm), options(vm.getOptions()), assembler(vm.getProgram().registers.size()) {}
+
+    vector<uint8_t> generate() {
+        assembler.bytes({0x53});             // push rbx, which also aligns the stack for calls
+        assembler.bytes({0x48, 0x89, 0xFB}); // mov rbx, rdi
+        for (auto& instruction : vm.getProgram().instructions) {
+            generate(instruction);
+        }
+        assembler.bytes({0x5B, 0xC3}); // pop rbx; ret
+        return assembler.getCode();
+    }
+
+    private:
+    void callback(const Instruction& instruction) {
+        assembler.bytes({0x48, 0xBF}); // mov rdi, imm64
+        assembler.imm64(reinterpret_cast<uintptr_t>(&vm));
+        assembler.bytes({0x48, 0xBE}); // mov rsi, imm64
+        assembler.imm64(reinterpret_cast<uintptr_t>(&instruction));
+        assembler.bytes({0x48, 0x89, 0xDA}); // mov rdx, rbx
+        assembler.call(reinterpret_cast<const void*>(&step));
+    }
+    void integer(const Instruction& i, initializer_list<uint8_t> opcode) {
+        assembler.loadInt(rax, i.a);
+        assembler.memory(opcode, rax, i.b);
+        assembler.storeInt(i.dst);
+    }
+    void divide(const Instruction& i, uint8_t result) {
+        assembler.loadInt(rax, i.a);
+        assembler.bytes({0x48, 0x99});          // cqo
+        assembler.memory({0x48, 0xF7}, 7, i.b); // idiv qword
+        assembler.storeInt(i.dst, result);
+    }
+    void shift(const Instruction& i, uint8_t extension) {
+        assembler.loadInt(rax, i.a);
+        assembler.loadInt(rcx, i.b);
+        assembler.bytes({0x48, 0xD3, static_cast<uint8_t>(0xC0 | extension << 3)});
+        assembler.storeInt(i.dst);
+    }
+    void unaryInteger(const Instruction& i, uint8_t extension) {
+        assembler.loadInt(rax, i.a);
+        assembler.bytes({0x48, 0xF7, static_cast<uint8_t>(0xC0 | extension << 3)});
+        assembler.storeInt(i.dst);
+    }
+    void floating(const Instruction& i, uint8_t opcode) {
+        assembler.loadDouble(xmm0, i.a);
+        assembler.memory({0xF2, 0x0F, opcode}, xmm0, i.b);
+        assembler.storeDouble(i.dst);
+    }
+    void callDouble(const Instruction& i, const void* function) {
+        assembler.loadDouble(xmm0, i.a);
+        assembler.loadDouble(xmm1, i.b);
+        assembler.call(function);
+        assembler.storeDouble(i.dst);
+    }
+    // integers if both operands are integers, otherwise doubles
+    void mixed(const Instruction& i, initializer_list<uint8_t> intOpcode, uint8_t doubleOpcode) {
+        assembler.tagMemory({0x8A}, rax, i.a); // mov al, byte
+        assembler.tagMemory({0x0A}, rax, i.b); // or al, byte
+        size_t fp = assembler.jump(0x75);
+        integer(i, intOpcode);
+        size_t done = assembler.jump(0xEB);
+        assembler.bind(fp);
+        assembler.convertDouble(xmm0, i.a);
+        assembler.convertDouble(xmm1, i.b);
+        assembler.bytes({0xF2, 0x0F, doubleOpcode, 0xC1});
+        assembler.storeDouble(i.dst);
+        assembler.bind(done);
+    }
+    void negate(const Instruction& i) {
+        assembler.loadInt(rax, i.a);
+        assembler.bytes({0x48, 0x0F, 0xBA, 0xF8, 0x3F}); // btc rax, 63
+        assembler.memory({0x48, 0x89}, rax, i.dst);
+    }
+    // a call of a function with double parameters straight into <cmath>
+    bool direct(const Instruction& i) {
+        auto& site = vm.getProgram().sites[i.site];
+        if (!site.floating || simd::hasKernel(i.function, options.accuracy)) {
+            return false;
+        }
+        if (site.parameters == 1 && unary(i.function)) {
+            assembler.loadDouble(xmm0, i.a);
+            assembler.call(reinterpret_cast<const void*>(unary(i.function)));
+            assembler.storeDouble(i.dst);
+            return true;
+        }
+        if (site.parameters == 2 && binary(i.function)) {
+            callDouble(i, reinterpret_cast<const void*>(binary(i.function)));
+            return true;
+        }
+        return false;
+    }
+
+    void generate(const Instruction& i) {
+        switch (i.op) {
+            case Opcode::move:
+                assembler.loadInt(rax, i.a);
+                assembler.memory({0x48, 0x89}, rax, i.dst);
+                assembler.tagMemory({0x8A}, rax, i.a); // mov al, byte
+                assembler.tagMemory({0x88}, rax, i.dst);
+                break;
+            case Opcode::to_double:
+                assembler.convertDouble(xmm0, i.a);
+                assembler.storeDouble(i.dst);
+                break;
+            case Opcode::check_int: {
+                assembler.testDouble(i.a);
+                size_t valid = assembler.jump(0x74);
+                callback(i);
+                assembler.bind(valid);
+                break;
+            }
+            case Opcode::add_int: integer(i, {0x48, 0x03}); break;
+            case Opcode::sub_int: integer(i, {0x48, 0x2B}); break;
+            case Opcode::mul_int: integer(i, {0x48, 0x0F, 0xAF}); break;
+            case Opcode::div_int: divide(i, rax); break;
+            case Opcode::mod_int: divide(i, rdx); break;
+            case Opcode::neg_int: unaryInteger(i, 3); break;
+            case Opcode::or_int: integer(i, {0x48, 0x0B}); break;
+            case Opcode::xor_int: integer(i, {0x48, 0x33}); break;
+            case Opcode::and_int: integer(i, {0x48, 0x23}); break;
+            case Opcode::shl_int: shift(i, 4); break;
+            case Opcode::shr_int: shift(i, 7); break;
+            case Opcode::comp_int: unaryInteger(i, 2); break;
+            case Opcode::add_double: floating(i, 0x58); break;
+            case Opcode::sub_double: floating(i, 0x5C); break;
+            case Opcode::mul_double: floating(i, 0x59); break;
+            case Opcode::div_double: floating(i, 0x5E); break;
+            case Opcode::mod_double:
+                callDouble(i, reinterpret_cast<const void*>(binary(FunctionType::fmod)));
+                break;
+            case Opcode::neg_double:
+                negate(i);
+                assembler.tag(i.dst, true);
+                break;
+            case Opcode::pow_double:
+                callDouble(i, reinterpret_cast<const void*>(binary(FunctionType::pow)));
+                break;
+            case Opcode::add_any: mixed(i, {0x48, 0x03}, 0x58); break;
+            case Opcode::sub_any: mixed(i, {0x48, 0x2B}, 0x5C); break;
+            case Opcode::mul_any: mixed(i, {0x48, 0x0F, 0xAF}, 0x59); break;
+            case Opcode::neg_any: {
+                assembler.testDouble(i.a);
+                size_t notDouble = assembler.jump(0x74);
+                negate(i);
+                assembler.tag(i.dst, true);
+                size_t done = assembler.jump(0xEB);
+                assembler.bind(notDouble);
+                unaryInteger(i, 3);
+                assembler.bind(done);
+                break;
+            }
+            case Opcode::call_any:
+                if (!direct(i)) {
+                    callback(i);
+                }
+                break;
+            case Opcode::ret: break;
+            default: callback(i);
+        }
+    }
+};
+
+} // namespace
+
+JIT::JIT(const VM& vm) {
+    auto code = Generator(vm).generate();
+    void* mapped = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1, 0);
+    if (mapped == MAP_FAILED) {
+        return;
+    }
+    memory = mapped;
+    size = code.size();
+    memcpy(memory, code.data(), code.size());
+    // the code is only made executable once it is no longer writable
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        return;
+    }
+    function = reinterpret_cast<void (*)(Register*)>(memory);
+}
+JIT::~JIT() noexcept {
+    if (memory) {
+        munmap(memory, size);
+    }
+}
+
+#else
+
+JIT::JIT(const VM&) {}
+JIT::~JIT() noexcept = default;
+
+#endif
+
+bool JIT::isCompiled() const { return function != nullptr; }
+void JIT::run(Register* registers) const { function(registers); }
+
+} // namespace evaluate
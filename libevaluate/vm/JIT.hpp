@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include <cstddef>
+
+namespace evaluate {
+class VM;
+
+// compiles the bytecode of a VM into x86-64 machine code that works on the same registers.
+// doubles use scalar SSE2, integers the general purpose registers and the functions of
+// Functions.hpp with double parameters are called directly, every other instruction calls back
+// into the VM. the memory is never writable and executable at the same time.
+// on other architectures, or if the memory cannot be mapped, nothing is compiled
+class JIT {
+    private:
+    void* memory = nullptr;
+    size_t size = 0;
+    void (*function)(Register* registers) = nullptr;
+
+    public:
+    // vm must outlive the JIT and keep its program
+    explicit JIT(const VM& vm);
+    ~JIT() noexcept;
+    JIT(const JIT&) = delete;
+    JIT& operator=(const JIT&) = delete;
+
+    bool isCompiled() const;
+    void run(Register* registers) const;
+};
+
+} // namespace evaluate
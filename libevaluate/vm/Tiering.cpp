@@ -0,0 +1,128 @@
+#include "Tiering.hpp"
+#include "Evaluator.hpp"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <variant>
+#include <vector>
+
+using namespace std;
+
+namespace evaluate {
+
+namespace {
+
+// the background thread that compiles the expressions of every Tiering in the order they got hot,
+// so promotions share one thread instead of starting one each. at exit it finishes the compilation
+// it runs and drops the waiting ones
+class Worker {
+    private:
+    std::mutex guard;
+    deque<function<void()>> jobs;
+    bool stopped = false;
+    counting_semaphore<> ready{0}; // released once per job and once to stop
+    std::thread thread;            // last, so it starts once the queue is constructed
+
+    public:
+    Worker() : thread([this]() { run(); }) {}
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+    ~Worker() {
+        {
+            lock_guard lock(guard);
+            stopped = true;
+        }
+        ready.release();
+        thread.join();
+    }
+
+    void submit(function<void()> job) {
+        {
+            lock_guard lock(guard);
+            jobs.push_back(move(job));
+        }
+        ready.release();
+    }
+
+    private:
+    void run() {
+        while (true) {
+            ready.acquire();
+            function<void()> job;
+            {
+                lock_guard lock(guard);
+                if (stopped) {
+                    return;
+                }
+                job = move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+Worker& worker() {
+    static Worker worker;
+    return worker;
+}
+
+} // namespace
+
+Tiering::Tiering(uint64_t threshold) : threshold(threshold), tier(make_shared<Tier>()) {}
+
+Evaluator* Tiering::count(const Evaluator& evaluator, uint64_t count) {
+    // the only writer, so no read-modify-write is needed
+    uint64_t before = evaluations.load(memory_order_relaxed);
+    evaluations.store(before + count, memory_order_relaxed);
+    if (Evaluator* promoted = tier->promoted.load(memory_order_acquire)) {
+        return promoted;
+    }
+    if (before < threshold && before + count >= threshold) {
+        promote(evaluator);
+    }
+    return nullptr;
+}
+const Evaluator* Tiering::getPromoted() const {
+    return tier->promoted.load(memory_order_acquire);
+}
+TierStatistics Tiering::getStatistics() const {
+    TierStatistics statistics;
+    statistics.evaluations = evaluations.load(memory_order_relaxed);
+    statistics.promotedAfter = promotedAfter.load(memory_order_relaxed);
+    statistics.promoted = tier->promoted.load(memory_order_acquire) != nullptr;
+    statistics.time = chrono::nanoseconds(tier->time.load(memory_order_relaxed));
+    return statistics;
+}
+
+// the worker compiles a copy, so the Evaluator can be moved meanwhile. it only keeps the tier
+// while it compiles, so a Tiering that is destroyed before is skipped
+void Tiering::promote(const Evaluator& evaluator) {
+    promotedAfter.store(evaluations.load(memory_order_relaxed), memory_order_relaxed);
+    vector<optional<variant<int64_t, double>>> unbound(evaluator.variables.size());
+    Options options = evaluator.options;
+    auto source = shared_ptr<const Evaluator>(
+        new Evaluator(evaluator, unbound, {.level = OptimizationLevel::O0}));
+    options.backend = Backend::jit;
+    options.dump = nullptr;
+    options.retain = Retain::source; // the promoted evaluator also evaluates columns with its AST
+    worker().submit([weak = weak_ptr<Tier>(tier), source, unbound, options]() {
+        auto tier = weak.lock();
+        if (!tier) {
+            return;
+        }
+        auto start = chrono::steady_clock::now();
+        tier->compiled = unique_ptr<Evaluator>(new Evaluator(*source, unbound, options));
+        tier->time.store(
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start)
+                .count(),
+            memory_order_relaxed);
+        tier->promoted.store(tier->compiled.get(), memory_order_release);
+    });
+}
+
+} // namespace evaluate
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "optimize/Statistics.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace evaluate {
+class Evaluator;
+
+// the tiers of an expression of Backend::tiered: the Evaluator walks its unoptimized AST and counts
+// its evaluations until the threshold, then a background thread that all Tierings share compiles a
+// copy with the optimization level and Backend::jit and publishes it, and the Evaluator delegates
+// to it. Evaluator::get is not thread-safe, so the counter has a single writer, but it and the
+// statistics can be read from any thread
+class Tiering {
+    public:
+    // what the compilation publishes, which outlives the Tiering while it is compiled
+    struct Tier {
+        std::atomic<int64_t> time = 0; // nanoseconds
+        std::unique_ptr<Evaluator> compiled;
+        std::atomic<Evaluator*> promoted = nullptr; // compiled once it can be used
+    };
+
+    private:
+    uint64_t threshold;
+    std::atomic<uint64_t> evaluations = 0;
+    std::atomic<uint64_t> promotedAfter = 0;
+    std::shared_ptr<Tier> tier;
+
+    public:
+    explicit Tiering(uint64_t threshold);
+    Tiering(const Tiering&) = delete;
+    Tiering& operator=(const Tiering&) = delete;
+    // counts count evaluations and returns the compiled tier if it is published, the compilation
+    // of evaluator starts when the threshold is reached
+    Evaluator* count(const Evaluator& evaluator, uint64_t count);
+    const Evaluator* getPromoted() const;
+    TierStatistics getStatistics() const;
+
+    private:
+    void promote(const Evaluator& evaluator);
+};
+
+} // namespace evaluate
@@ -0,0 +1,312 @@
+#include "VM.hpp"
+#include "Functions.hpp"
+#include "math/VectorMath.hpp"
+#include "util/Error.hpp"
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+// labels as values are a GNU extension, EVALUATE_SWITCH_DISPATCH forces the portable switch
+#if defined(__GNUC__) && !defined(EVALUATE_SWITCH_DISPATCH)
+#define EVALUATE_COMPUTED_GOTO
+#endif
+
+using namespace std;
+
+namespace evaluate {
+
+VM::VM(shared_ptr<const Code> code, const Options& options, Program program)
+    : code(move(code)), options(options), program(move(program)) {
+    size_t size = this->program.registers.size();
+    // the tags fill whole registers
+    registers.resize(size + (size + sizeof(Register) - 1) / sizeof(Register));
+    for (uint32_t i = 0; i < size; ++i) {
+        store(registers.data(), i, this->program.registers[i]);
+    }
+    if (options.backend == Backend::jit) {
+        jit = make_unique<JIT>(*this);
+        if (!jit->isCompiled()) {
+            jit.reset();
+        }
+    }
+}
+
+const Program& VM::getProgram() const { return program; }
+const Options& VM::getOptions() const { return options; }
+bool VM::isCompiled() const { return jit != nullptr; }
+
+uint8_t* VM::tags(Register* r) const {
+    return reinterpret_cast<uint8_t*>(r + program.registers.size());
+}
+const uint8_t* VM::tags(const Register* r) const {
+    return reinterpret_cast<const uint8_t*>(r + program.registers.size());
+}
+Value VM::load(const Register* r, uint32_t index) const {
+    return tags(r)[index] ? Value(r[index].f) : Value(r[index].i);
+}
+void VM::store(Register* r, uint32_t index, Value value) const {
+    if (value.fp) {
+        r[index].f = value.f;
+    } else {
+        r[index].i = value.i;
+    }
+    tags(r)[index] = value.fp;
+}
+
+variant<int64_t, double> VM::run(span<const variant<int64_t, double>> values) {
+    Register* r = registers.data();
+    uint8_t* fp = tags(r);
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        store(r, i, program.types[i] == ValueType::floating ? Value(getAsDouble(values[i])) :
+                                                              Value(values[i]));
+    }
+    if (jit) {
+        jit->run(r);
+        return load(r, program.instructions.back().a).get();
+    }
+    auto integer = [r, fp](uint32_t dst, int64_t value) {
+        r[dst].i = value;
+        fp[dst] = false;
+    };
+    auto floating = [r, fp](uint32_t dst, double value) {
+        r[dst].f = value;
+        fp[dst] = true;
+    };
+    auto asDouble = [r, fp](uint32_t index) {
+        return fp[index] ? r[index].f : static_cast<double>(r[index].i);
+    };
+    const Instruction* pc = program.instructions.data();
+#ifdef EVALUATE_COMPUTED_GOTO
+// only the dispatch uses labels as values, -Wpedantic stays on for the rest of the VM
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    static const void* const labels[] = {
+#define EVALUATE_LABEL(name) &&op_##name,
+        EVALUATE_OPCODES(EVALUATE_LABEL)
+#undef EVALUATE_LABEL
+    };
+#define CASE(name) op_##name:
+#define NEXT() goto* labels[static_cast<size_t>((++pc)->op)]
+    goto* labels[static_cast<size_t>(pc->op)];
+#else
+#define CASE(name) case Opcode::name:
+#define NEXT()                                                                                     \
+    ++pc;                                                                                          \
+    continue
+    for (;;) {
+        switch (pc->op) {
+#endif
+    CASE(move) {
+        r[pc->dst] = r[pc->a];
+        fp[pc->dst] = fp[pc->a];
+    }
+    NEXT();
+    CASE(to_double) floating(pc->dst, asDouble(pc->a));
+    NEXT();
+    CASE(check_int) checkInteger(*pc, load(r, pc->a));
+    NEXT();
+    CASE(add_int) integer(pc->dst, r[pc->a].i + r[pc->b].i);
+    NEXT();
+    CASE(sub_int) integer(pc->dst, r[pc->a].i - r[pc->b].i);
+    NEXT();
+    CASE(mul_int) integer(pc->dst, r[pc->a].i * r[pc->b].i);
+    NEXT();
+    CASE(div_int) integer(pc->dst, r[pc->a].i / r[pc->b].i);
+    NEXT();
+    CASE(div_const_int)
+    integer(pc->dst, program.sites[pc->site].divisor->divide(r[pc->a].i));
+    NEXT();
+    CASE(mod_int) integer(pc->dst, r[pc->a].i % r[pc->b].i);
+    NEXT();
+    CASE(mod_const_int)
+    integer(pc->dst, program.sites[pc->site].divisor->modulo(r[pc->a].i));
+    NEXT();
+    CASE(neg_int) integer(pc->dst, -r[pc->a].i);
+    NEXT();
+    CASE(or_int) integer(pc->dst, r[pc->a].i | r[pc->b].i);
+    NEXT();
+    CASE(xor_int) integer(pc->dst, r[pc->a].i ^ r[pc->b].i);
+    NEXT();
+    CASE(and_int) integer(pc->dst, r[pc->a].i & r[pc->b].i);
+    NEXT();
+    CASE(shl_int) integer(pc->dst, r[pc->a].i << r[pc->b].i);
+    NEXT();
+    CASE(shr_int) integer(pc->dst, r[pc->a].i >> r[pc->b].i);
+    NEXT();
+    CASE(comp_int) integer(pc->dst, ~r[pc->a].i);
+    NEXT();
+    CASE(add_double) floating(pc->dst, r[pc->a].f + r[pc->b].f);
+    NEXT();
+    CASE(sub_double) floating(pc->dst, r[pc->a].f - r[pc->b].f);
+    NEXT();
+    CASE(mul_double) floating(pc->dst, r[pc->a].f * r[pc->b].f);
+    NEXT();
+    CASE(div_double) floating(pc->dst, r[pc->a].f / r[pc->b].f);
+    NEXT();
+    CASE(mod_double) floating(pc->dst, fmod(r[pc->a].f, r[pc->b].f));
+    NEXT();
+    CASE(neg_double) floating(pc->dst, -r[pc->a].f);
+    NEXT();
+    CASE(pow_double) floating(pc->dst, pow(r[pc->a].f, r[pc->b].f));
+    NEXT();
+    CASE(call_double) store(r, pc->dst, callKernel(*pc, r));
+    NEXT();
+    CASE(add_any) {
+        if (fp[pc->a] | fp[pc->b]) {
+            floating(pc->dst, asDouble(pc->a) + asDouble(pc->b));
+        } else {
+            integer(pc->dst, r[pc->a].i + r[pc->b].i);
+        }
+    }
+    NEXT();
+    CASE(sub_any) {
+        if (fp[pc->a] | fp[pc->b]) {
+            floating(pc->dst, asDouble(pc->a) - asDouble(pc->b));
+        } else {
+            integer(pc->dst, r[pc->a].i - r[pc->b].i);
+        }
+    }
+    NEXT();
+    CASE(mul_any) {
+        if (fp[pc->a] | fp[pc->b]) {
+            floating(pc->dst, asDouble(pc->a) * asDouble(pc->b));
+        } else {
+            integer(pc->dst, r[pc->a].i * r[pc->b].i);
+        }
+    }
+    NEXT();
+    CASE(div_any) store(r, pc->dst, divide(*pc, load(r, pc->a), load(r, pc->b)));
+    NEXT();
+    CASE(mod_any) store(r, pc->dst, modulo(*pc, load(r, pc->a), load(r, pc->b)));
+    NEXT();
+    CASE(neg_any) {
+        if (fp[pc->a]) {
+            floating(pc->dst, -r[pc->a].f);
+        } else {
+            integer(pc->dst, -r[pc->a].i);
+        }
+    }
+    NEXT();
+    CASE(pow_any) store(r, pc->dst, power(*pc, load(r, pc->a), load(r, pc->b)));
+    NEXT();
+    CASE(call_any) store(r, pc->dst, call(*pc, r));
+    NEXT();
+    CASE(ret) return load(r, pc->a).get();
+#ifdef EVALUATE_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#else
+        }
+    }
+#endif
+#undef CASE
+#undef NEXT
+}
+
+void VM::execute(const Instruction& instruction, Register* r) const {
+    auto& i = instruction;
+    switch (i.op) {
+        case Opcode::check_int: checkInteger(i, load(r, i.a)); break;
+        case Opcode::div_const_int:
+            r[i.dst].i = program.sites[i.site].divisor->divide(r[i.a].i);
+            tags(r)[i.dst] = false;
+            break;
+        case Opcode::mod_const_int:
+            r[i.dst].i = program.sites[i.site].divisor->modulo(r[i.a].i);
+            tags(r)[i.dst] = false;
+            break;
+        case Opcode::div_any: store(r, i.dst, divide(i, load(r, i.a), load(r, i.b))); break;
+        case Opcode::mod_any: store(r, i.dst, modulo(i, load(r, i.a), load(r, i.b))); break;
+        case Opcode::pow_any: store(r, i.dst, power(i, load(r, i.a), load(r, i.b))); break;
+        case Opcode::call_double: store(r, i.dst, callKernel(i, r)); break;
+        case Opcode::call_any: store(r, i.dst, call(i, r)); break;
+        default: error("Evaluation Error: no callback for the instruction");
+    }
+}
+void VM::checkInteger(const Instruction& instruction, Value value) const {
+    if (value.fp) {
+        fail(instruction, "Evaluation Error: invalid usage of bitwise operator on double");
+    }
+}
+Value VM::divide(const Instruction& instruction, Value l, Value r) const {
+    auto& site = program.sites[instruction.site];
+    if (l.fp || r.fp) {
+        auto& reciprocal = site.reciprocal;
+        return Value(reciprocal ? l.asDouble() * *reciprocal : l.asDouble() / r.asDouble());
+    }
+    auto& divisor = site.divisor;
+    return Value(divisor ? divisor->divide(l.i) : l.i / r.i);
+}
+Value VM::modulo(const Instruction& instruction, Value l, Value r) const {
+    if (l.fp || r.fp) {
+        return Value(fmod(l.asDouble(), r.asDouble()));
+    }
+    auto& divisor = program.sites[instruction.site].divisor;
+    return Value(divisor ? divisor->modulo(l.i) : l.i % r.i);
+}
+Value VM::power(const Instruction& instruction, Value base, Value exponent) const {
+    if (base.fp || exponent.fp) {
+        return Value(pow(base.asDouble(), exponent.asDouble()));
+    }
+    return power(instruction, base.i, exponent.i, program.sites[instruction.site].integerPower);
+}
+Value VM::power(const Instruction& instruction, int64_t base, int64_t exponent,
+                IntegerPower integerPower) const {
+    int64_t result;
+    if (exponent < 0) {
+        return Value(pow(base, exponent));
+    } else if (integerPower ? integerPower(base, result) : ipow(base, exponent, result)) {
+        return Value(result);
+    } else if (options.overflow == OverflowPolicy::error) {
+        fail(instruction, "Evaluation Error: integer overflow in exponentiation");
+    } else {
+        return Value(pow(base, exponent));
+    }
+}
+// the parameters are already converted to double
+Value VM::callKernel(const Instruction& instruction, const Register* r) const {
+    array<uint32_t, 3> operands{instruction.a, instruction.b, instruction.c};
+    array<span<const double>, 3> params{};
+    for (size_t i = 0; i < program.sites[instruction.site].parameters; ++i) {
+        params[i] = span(&r[operands[i]].f, 1);
+    }
+    double result;
+    simd::call(instruction.function, options.accuracy, params, span(&result, 1));
+    return Value(result);
+}
+Value VM::call(const Instruction& instruction, const Register* r) const {
+    auto type = instruction.function;
+    array<variant<int64_t, double>, 3> arguments{load(r, instruction.a).get(),
+                                                 load(r, instruction.b).get(),
+                                                 load(r, instruction.c).get()};
+    span<variant<int64_t, double>> values(arguments.data(),
+                                          program.sites[instruction.site].parameters);
+    if (type == FunctionType::pow && values.size() == 2 && holds_alternative<int64_t>(values[0]) &&
+        holds_alternative<int64_t>(values[1])) {
+        return power(instruction, std::get<int64_t>(values[0]), std::get<int64_t>(values[1]),
+                     nullptr);
+    } else if (simd::hasKernel(type, options.accuracy)) {
+        array<double, 3> doubles{};
+        array<span<const double>, 3> params{};
+        for (size_t i = 0; i < values.size(); ++i) {
+            doubles[i] = getAsDouble(values[i]);
+            params[i] = span(&doubles[i], 1);
+        }
+        double result;
+        simd::call(type, options.accuracy, params, span(&result, 1));
+        return Value(result);
+    }
+    return Value(evaluate::call(type, values));
+}
+void VM::fail(const Instruction& instruction, const string& msg) const {
+    if (program.locations.empty()) {
+        error(msg + " at site " + to_string(instruction.site));
+    }
+    auto& location = program.locations[instruction.site];
+    if (code) {
+        error(location.offset, location.size, *code, msg);
+    }
+    error(location.offset, location.size, msg);
+}
+
+} // namespace evaluate
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "JIT.hpp"
+#include "Options.hpp"
+#include "math/Integer.hpp"
+#include "util/Code.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace evaluate {
+
+// runs the register bytecode of the Compiler, with computed goto dispatch where the compiler
+// supports it and a switch otherwise. for Backend::jit the bytecode is compiled to machine code
+// if the architecture is supported. the VM only keeps the source with Retain::source
+class VM {
+    private:
+    std::shared_ptr<const Code> code; // for the location of evaluation errors, can be nullptr
+    Options options;
+    Program program;
+    std::vector<Register> registers; // followed by their tags, which say whether they hold doubles
+    std::unique_ptr<JIT> jit;
+
+    public:
+    VM(std::shared_ptr<const Code> code, const Options& options, Program program);
+    VM(const VM&) = delete;
+    VM& operator=(const VM&) = delete;
+    // values has a value for every variable, the ones of integer variables are integers
+    std::variant<int64_t, double> run(std::span<const std::variant<int64_t, double>> values);
+    // executes an instruction the machine code of the JIT calls back for
+    void execute(const Instruction& instruction, Register* r) const;
+    const Program& getProgram() const;
+    const Options& getOptions() const;
+    bool isCompiled() const;
+
+    private:
+    // the tags of the registers r
+    uint8_t* tags(Register* r) const;
+    const uint8_t* tags(const Register* r) const;
+    Value load(const Register* r, uint32_t index) const;
+    void store(Register* r, uint32_t index, Value value) const;
+    void checkInteger(const Instruction& instruction, Value value) const;
+    Value divide(const Instruction& instruction, Value l, Value r) const;
+    Value modulo(const Instruction& instruction, Value l, Value r) const;
+    Value power(const Instruction& instruction, Value base, Value exponent) const;
+    Value power(const Instruction& instruction, int64_t base, int64_t exponent,
+                IntegerPower integerPower) const;
+    Value callKernel(const Instruction& instruction, const Register* r) const;
+    Value call(const Instruction& instruction, const Register* r) const;
+    // reports the evaluation error msg of instruction where its site is in the source
+    [[noreturn]] void fail(const Instruction& instruction, const std::string& msg) const;
+};
+
+} // namespace evaluate
@@ -1,10 +1,1152 @@
 //
 // Created by he on 12/27/20.
 //
+#include <Evaluator.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <ce/Evaluate.hpp>
+#include <ce/Expression.hpp>
+#include <analyze/AST.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <new>
+#include <expressions.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <math/VectorMath.hpp>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
 
+using namespace evaluate;
 using namespace std;
 
-int main() {
-    cout << "hello world!" << endl;
-}
\ No newline at end of file
+// every allocation of the test binary is counted, so tests can check that code does not allocate.
+// all forms of new and delete are replaced, so every allocation is freed by the same free
+static atomic<size_t> allocations = 0;
+
+static void* allocate(size_t size) noexcept {
+    allocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+static void* allocate(size_t size, align_val_t alignment) noexcept {
+    allocations.fetch_add(1, memory_order_relaxed);
+    auto align = static_cast<size_t>(alignment);
+    return aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+// not inlined, gcc warns about free in an inlined delete of memory from new
+[[gnu::noinline]] static void release(void* memory) noexcept { free(memory); }
+
+void* operator new(size_t size) {
+    if (void* memory = allocate(size)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+void* operator new(size_t size, align_val_t alignment) {
+    if (void* memory = allocate(size, alignment)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+void* operator new(size_t size, const nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept {
+    return allocate(size, alignment);
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new[](size_t size, align_val_t alignment) { return operator new(size, alignment); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept {
+    return allocate(size, alignment);
+}
+void operator delete(void* memory) noexcept { release(memory); }
+void operator delete(void* memory, size_t) noexcept { release(memory); }
+void operator delete(void* memory, align_val_t) noexcept { release(memory); }
+void operator delete(void* memory, size_t, align_val_t) noexcept { release(memory); }
+void operator delete(void* memory, const nothrow_t&) noexcept { release(memory); }
+void operator delete(void* memory, align_val_t, const nothrow_t&) noexcept { release(memory); }
+void operator delete[](void* memory) noexcept { release(memory); }
+void operator delete[](void* memory, size_t) noexcept { release(memory); }
+void operator delete[](void* memory, align_val_t) noexcept { release(memory); }
+void operator delete[](void* memory, size_t, align_val_t) noexcept { release(memory); }
+void operator delete[](void* memory, const nothrow_t&) noexcept { release(memory); }
+void operator delete[](void* memory, align_val_t, const nothrow_t&) noexcept { release(memory); }
+
+// the allocations of f
+template <typename F> static size_t allocationsOf(F f) {
+    size_t before = allocations.load(memory_order_relaxed);
+    f();
+    return allocations.load(memory_order_relaxed) - before;
+}
+
+// distance between a and b in units in the last place
+static uint64_t ulp(double a, double b) {
+    if (isnan(a) && isnan(b)) {
+        return 0;
+    }
+    int64_t x, y;
+    memcpy(&x, &a, sizeof(double));
+    memcpy(&y, &b, sizeof(double));
+    x = x < 0 ? INT64_MIN - x : x;
+    y = y < 0 ? INT64_MIN - y : y;
+    return x > y ? x - y : y - x;
+}
+
+static vector<double> inputs(double from, double to) {
+    mt19937_64 generator(42);
+    uniform_real_distribution<double> distribution(from, to);
+    vector<double> values{0.0, -0.0, 1e-300, -1e-300, 5e-324, numeric_limits<double>::infinity(),
+                          -numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN()};
+    for (size_t i = 0; i < 100000; ++i) {
+        values.push_back(distribution(generator));
+    }
+    return values;
+}
+
+static void expectWithin(FunctionType type, Accuracy accuracy, double (*reference)(double),
+                         double from, double to, uint64_t maxUlp) {
+    auto x = inputs(from, to);
+    vector<double> result(x.size());
+    span<const double> params[] = {x};
+    simd::call(type, accuracy, params, result);
+    for (size_t i = 0; i < x.size(); ++i) {
+        ASSERT_LE(ulp(result[i], reference(x[i])), maxUlp) << "x = " << x[i];
+    }
+}
+
+static void expectWithin(FunctionType type, Accuracy accuracy, double (*reference)(double, double),
+                         double from, double to, uint64_t maxUlp) {
+    auto x = inputs(from, to);
+    auto y = inputs(-to, to);
+    reverse(y.begin(), y.end());
+    vector<double> result(x.size());
+    span<const double> params[] = {x, y};
+    simd::call(type, accuracy, params, result);
+    for (size_t i = 0; i < x.size(); ++i) {
+        ASSERT_LE(ulp(result[i], reference(x[i], y[i])), maxUlp) << x[i] << ", " << y[i];
+    }
+}
+
+TEST(VectorMath, Precise) {
+    expectWithin(FunctionType::exp, Accuracy::precise, std::exp, -750, 750, 1);
+    expectWithin(FunctionType::exp2, Accuracy::precise, std::exp2, -1100, 1100, 1);
+    expectWithin(FunctionType::expm1, Accuracy::precise, std::expm1, -2, 2, 1);
+    expectWithin(FunctionType::log, Accuracy::precise, std::log, -1, 1e6, 1);
+    expectWithin(FunctionType::log2, Accuracy::precise, std::log2, 0.5, 2, 1);
+    expectWithin(FunctionType::sqrt, Accuracy::precise, std::sqrt, -1, 1e6, 0);
+    expectWithin(FunctionType::sin, Accuracy::precise, std::sin, -1e6, 1e6, 1);
+    expectWithin(FunctionType::cos, Accuracy::precise, std::cos, -100, 100, 1);
+    expectWithin(FunctionType::atan, Accuracy::precise, std::atan, -10, 10, 1);
+    expectWithin(FunctionType::erf, Accuracy::precise, std::erf, -7, 7, 1);
+    expectWithin(FunctionType::pow, Accuracy::precise, std::pow, 0, 20, 1);
+    expectWithin(FunctionType::atan2, Accuracy::precise, std::atan2, -10, 10, 1);
+}
+
+TEST(VectorMath, Fast) {
+    expectWithin(FunctionType::sin, Accuracy::fast, std::sin, -100, 100, 1);
+    expectWithin(FunctionType::log10, Accuracy::fast, std::log10, 0, 1e6, 4);
+    expectWithin(FunctionType::tan, Accuracy::fast, std::tan, -100, 100, 4);
+    expectWithin(FunctionType::sinh, Accuracy::fast, std::sinh, -30, 30, 4);
+    expectWithin(FunctionType::cosh, Accuracy::fast, std::cosh, -30, 30, 4);
+    expectWithin(FunctionType::tanh, Accuracy::fast, std::tanh, -30, 30, 4);
+}
+
+TEST(VectorMath, Tiers) {
+    EXPECT_FALSE(simd::hasKernel(FunctionType::exp, Accuracy::standard));
+    EXPECT_TRUE(simd::hasKernel(FunctionType::exp, Accuracy::precise));
+    EXPECT_FALSE(simd::hasKernel(FunctionType::tanh, Accuracy::precise));
+    EXPECT_TRUE(simd::hasKernel(FunctionType::tanh, Accuracy::fast));
+    EXPECT_FALSE(simd::hasKernel(FunctionType::tgamma, Accuracy::fast));
+    EXPECT_TRUE(simd::hasKernel(FunctionType::fma, Accuracy::standard));
+}
+
+TEST(Evaluator, Variables) {
+    Evaluator evaluator("x * sin(y) + 1", {"x", "y"}, {Accuracy::precise});
+    vector<variant<int64_t, double>> values{2.0, 0.5};
+    EXPECT_EQ(std::get<double>(evaluator.get(values)), 2.0 * std::sin(0.5) + 1);
+}
+
+TEST(Evaluator, Batch) {
+    Evaluator evaluator("x * exp(y) + 1", {"x", "y"}, {Accuracy::fast});
+    vector<Column> columns{vector<int64_t>{1, 2, 3, 4, 5}, vector<double>{0.0, 0.5, 1.0, 1.5, 2.0}};
+    auto result = std::get<vector<double>>(evaluator.get(columns, 5));
+    for (size_t i = 0; i < result.size(); ++i) {
+        vector<variant<int64_t, double>> row{int64_t(i + 1), 0.5 * i};
+        EXPECT_EQ(result[i], std::get<double>(evaluator.get(row)));
+    }
+}
+
+TEST(Evaluator, IntegerPower) {
+    EXPECT_EQ(std::get<int64_t>(eval("3 ** 39")), 4052555153018976267);
+    EXPECT_EQ(std::get<int64_t>(eval("pow(-3, 39)")), -4052555153018976267);
+    EXPECT_EQ(std::get<double>(eval("3 ** 40")), std::pow(3.0, 40.0));
+    EXPECT_EQ(std::get<double>(eval("2 ** -1")), 0.5);
+    EXPECT_EXIT(Evaluator("3 ** 40", {}, {.overflow = OverflowPolicy::error}).get(),
+                testing::ExitedWithCode(1), "integer overflow");
+
+    Evaluator evaluator("(x ** 20) + (x ** e)", {"x", "e"});
+    for (int64_t x = -8; x <= 8; ++x) {
+        vector<variant<int64_t, double>> values{x, int64_t(20)};
+        int64_t expected;
+        ipow(x, 20, expected);
+        EXPECT_EQ(std::get<int64_t>(evaluator.get(values)), 2 * expected);
+    }
+    vector<Column> columns{vector<int64_t>{2, 3, -5}, vector<int64_t>{10, 20, 3}};
+    EXPECT_EQ(std::get<vector<int64_t>>(evaluator.get(columns, 3)),
+              (vector<int64_t>{1048576 + 1024, 2 * 3486784401, 95367431640625 - 125}));
+}
+
+TEST(Evaluator, ConstantDivisor) {
+    mt19937_64 generator(7);
+    vector<int64_t> rows{INT64_MIN, INT64_MAX, 0, -1, 1};
+    for (size_t i = 0; i < 1000; ++i) {
+        rows.push_back(static_cast<int64_t>(generator()) >> (i % 64));
+    }
+    for (int64_t d : vector<int64_t>{2, 3, 7, 60, 1000, 1024, INT64_MAX}) {
+        Evaluator div("x / " + to_string(d), {"x"});
+        Evaluator mod("x % " + to_string(d), {"x"});
+        vector<Column> columns{rows};
+        auto quotients = std::get<vector<int64_t>>(div.get(columns, rows.size()));
+        auto remainders = std::get<vector<int64_t>>(mod.get(columns, rows.size()));
+        for (size_t i = 0; i < rows.size(); ++i) {
+            vector<variant<int64_t, double>> values{rows[i]};
+            EXPECT_EQ(quotients[i], rows[i] / d);
+            EXPECT_EQ(remainders[i], rows[i] % d);
+            EXPECT_EQ(std::get<int64_t>(div.get(values)), rows[i] / d);
+            EXPECT_EQ(std::get<int64_t>(mod.get(values)), rows[i] % d);
+        }
+    }
+    for (int64_t d : vector<int64_t>{-2, -3, -1000, INT64_MIN, INT64_MIN + 1}) {
+        SignedDivisor divisor(d);
+        for (int64_t n : rows) {
+            EXPECT_EQ(divisor.divide(n), n / d);
+            EXPECT_EQ(divisor.modulo(n), n % d);
+        }
+    }
+
+    vector<variant<int64_t, double>> values{0.1};
+    EXPECT_EQ(std::get<double>(Evaluator("x / 3", {"x"}).get(values)), 0.1 / 3);
+    EXPECT_EQ(std::get<double>(Evaluator("x / 3", {"x"}, {.fp = FloatPolicy::fast}).get(values)),
+              0.1 * (1.0 / 3));
+    EXPECT_EQ(std::get<double>(Evaluator("x / 0.25", {"x"}).get(values)), 0.1 / 0.25);
+
+    // the reciprocal of a tiny divisor is infinite, and the one of 2 ** -1023 is exact
+    vector<double> dividends{0.0, 1e-300, -3.5};
+    for (int exponent : {-1074, -1030, -1023}) {
+        double divisor = ldexp(1.0, exponent);
+        for (FloatPolicy fp : {FloatPolicy::strict, FloatPolicy::fast}) {
+            for (Backend backend : {Backend::tree, Backend::bytecode, Backend::jit}) {
+                Evaluator tiny("x / (2 ** " + to_string(exponent) + ")", {"x"},
+                               {.fp = fp, .backend = backend});
+                vector<Column> columns{dividends};
+                auto quotients = std::get<vector<double>>(tiny.get(columns, dividends.size()));
+                for (size_t i = 0; i < dividends.size(); ++i) {
+                    vector<variant<int64_t, double>> row{dividends[i]};
+                    EXPECT_EQ(std::get<double>(tiny.get(row)), dividends[i] / divisor);
+                    EXPECT_EQ(quotients[i], dividends[i] / divisor);
+                }
+            }
+        }
+    }
+}
+
+TEST(Evaluator, BitManipulation) {
+    EXPECT_EQ(std::get<int64_t>(eval("popcount(-1)")), 64);
+    EXPECT_EQ(std::get<int64_t>(eval("clz(1)")), 63);
+    EXPECT_EQ(std::get<int64_t>(eval("ctz(0)")), 64);
+    EXPECT_EQ(std::get<int64_t>(eval("rotl(1, 65)")), 2);
+    EXPECT_EQ(std::get<int64_t>(eval("rotr(1, 1)")), INT64_MIN);
+    EXPECT_EQ(std::get<int64_t>(eval("bswap(255)")), -72057594037927936);
+    EXPECT_EQ(std::get<int64_t>(eval("bextract(65280, 8, 4)")), 15);
+    EXPECT_EQ(std::get<int64_t>(eval("gcd(-12, 18)")), 6);
+    EXPECT_EQ(std::get<int64_t>(eval("modpow(-2, 63, 1000000007)")), 708828003);
+    EXPECT_EXIT(eval("popcount(1.5)"), testing::ExitedWithCode(1), "floating point argument");
+    EXPECT_EXIT(eval("gcd(2, 3 * sin(1))"), testing::ExitedWithCode(1), "floating point argument");
+    EXPECT_EXIT(eval("modpow(2, -1, 7)"), testing::ExitedWithCode(1), "modpow");
+
+    mt19937_64 generator(29);
+    vector<int64_t> x, y;
+    for (size_t i = 0; i < 1000; ++i) {
+        x.push_back(static_cast<int64_t>(generator()));
+        y.push_back(static_cast<int64_t>(generator() % 200));
+    }
+    vector<Column> columns{x, y};
+    for (string function : {"popcount(x)", "clz(x)", "ctz(x)", "rotl(x, y)", "rotr(x, y)",
+                            "bswap(x)", "bextract(x, y % 64, 9)", "gcd(x, y)",
+                            "modpow(x, y, 1000003)"}) {
+        Evaluator evaluator(function, {"x", "y"});
+        auto result = std::get<vector<int64_t>>(evaluator.get(columns, x.size()));
+        for (size_t i = 0; i < x.size(); ++i) {
+            vector<variant<int64_t, double>> values{x[i], y[i]};
+            EXPECT_EQ(result[i], std::get<int64_t>(evaluator.get(values))) << function;
+        }
+    }
+    vector<Column> doubles{vector<double>{1.0}, vector<int64_t>{1}};
+    EXPECT_EXIT(Evaluator("gcd(x, y)", {"x", "y"}).get(doubles, 1), testing::ExitedWithCode(1),
+                "integer function");
+}
+
+TEST(Evaluator, Idioms) {
+    Options fast{.fp = FloatPolicy::fast};
+    vector<pair<string, string_view>> idioms{{"log(1 + x)", "log1p"},
+                                             {"log(x + 1.0)", "log1p"},
+                                             {"exp(x) - 1", "expm1"},
+                                             {"sqrt(x * x + y * y)", "hypot"},
+                                             {"sqrt((x ** 2) + y * y)", "hypot"},
+                                             {"x * y + 0.5", "fma"},
+                                             {"x * 2.0 - y", "fma"}};
+    vector<variant<int64_t, double>> values{1e-10, 3.0};
+    for (auto& [expression, idiom] : idioms) {
+        Evaluator evaluator(expression, {"x", "y"}, fast);
+        ASSERT_EQ(evaluator.getRewrites().size(), 1) << expression;
+        EXPECT_EQ(evaluator.getRewrites()[0].name, idiom);
+        EXPECT_EQ(evaluator.getRewrites()[0].codeRef.str(), expression);
+        EXPECT_TRUE(Evaluator(expression, {"x", "y"}).getRewrites().empty());
+    }
+    EXPECT_EQ(std::get<double>(Evaluator("log(1 + x)", {"x", "y"}, fast).get(values)),
+              log1p(1e-10));
+    EXPECT_EQ(std::get<double>(Evaluator("exp(x) - 1", {"x", "y"}, fast).get(values)),
+              expm1(1e-10));
+    EXPECT_EQ(std::get<double>(Evaluator("sqrt(x * x + y * y)", {"x", "y"}, fast).get(values)),
+              hypot(1e-10, 3.0));
+    vector<Column> columns{vector<double>{0.1, 0.2}, vector<double>{3.0, 1e300}};
+    EXPECT_EQ(std::get<vector<double>>(
+                  Evaluator("sqrt(x * x + y * y)", {"x", "y"}, fast).get(columns, 2)),
+              (vector<double>{hypot(0.1, 3.0), hypot(0.2, 1e300)}));
+
+    // integer arithmetic keeps its type, and the operands are rewritten as well
+    EXPECT_TRUE(Evaluator("x * y + 1", {"x", "y"}, fast).getRewrites().empty());
+    EXPECT_EQ(Evaluator("log(1 + (exp(x) - 1))", {"x"}, fast).getRewrites().size(), 2);
+}
+
+TEST(Evaluator, ConstantFolding) {
+    for (string expression : {"2 ** 10", "pow(2, 10)", "sqrt(2) * 3", "(-5) % 3", "~1 << 4"}) {
+        Evaluator evaluator(expression);
+        auto& ast = evaluator.getAST();
+        ASSERT_EQ(ast.getType(), AST::Type::VALUE) << expression;
+        EXPECT_EQ(ast.getCode(), expression);
+        EXPECT_EQ(static_cast<const VALUE&>(ast).getValue(), eval(expression));
+    }
+    EXPECT_FALSE(static_cast<const VALUE&>(Evaluator("pow(2, 10)").getAST()).isFP());
+    EXPECT_TRUE(static_cast<const VALUE&>(Evaluator("2 ** 100").getAST()).isFP());
+
+    Evaluator evaluator("x * (sqrt(2) * 3) + (2 ** 10)", {"x"});
+    auto& sum = static_cast<const BinaryAST&>(evaluator.getAST());
+    ASSERT_EQ(sum.getRExpr().getType(), AST::Type::VALUE);
+    EXPECT_EQ(sum.getRExpr().getCode(), "2 ** 10");
+    auto& product = static_cast<const BinaryAST&>(sum.getLExpr());
+    EXPECT_EQ(product.getRExpr().getType(), AST::Type::VALUE);
+    vector<variant<int64_t, double>> values{int64_t(2)};
+    EXPECT_EQ(std::get<double>(evaluator.get(values)), 2 * (std::sqrt(2) * 3) + 1024);
+
+    EXPECT_EQ(Evaluator("1 / 0").getAST().getType(), AST::Type::DIV);
+}
+
+TEST(Evaluator, CommonSubexpressions) {
+    Evaluator evaluator("s * exp(-r * t) + k * exp(-r * t) - exp(-r * t)", {"s", "k", "r", "t"});
+    auto& sharing = evaluator.getSharingStatistics();
+    EXPECT_EQ(sharing.nodes, 21);
+    EXPECT_EQ(sharing.expressions, 1);
+    EXPECT_EQ(sharing.deduplicated, 10);
+    vector<variant<int64_t, double>> values{100.0, 95.0, 0.05, int64_t(2)};
+    double discount = std::exp(-0.05 * 2);
+    EXPECT_EQ(std::get<double>(evaluator.get(values)),
+              100.0 * discount + (95.0 * discount - discount));
+    values[2] = 0.1;
+    discount = std::exp(-0.1 * 2);
+    EXPECT_EQ(std::get<double>(evaluator.get(values)),
+              100.0 * discount + (95.0 * discount - discount));
+    vector<Column> columns{vector<double>{100.0}, vector<double>{95.0}, vector<double>{0.1},
+                           vector<int64_t>{2}};
+    EXPECT_EQ(std::get<vector<double>>(evaluator.get(columns, 1))[0],
+              100.0 * discount + (95.0 * discount - discount));
+
+    // the inner expression is shared as well when it also occurs on its own
+    Evaluator nested("exp(x * y) + exp(x * y) + x * y", {"x", "y"});
+    EXPECT_EQ(nested.getSharingStatistics().expressions, 2);
+    EXPECT_EQ(Evaluator("x * y + y * x", {"x", "y"}).getSharingStatistics().expressions, 0);
+    EXPECT_EQ(Evaluator("x + x", {"x"}).getSharingStatistics().expressions, 0);
+}
+
+TEST(Evaluator, Simplification) {
+    Options fast{.fp = FloatPolicy::fast};
+    auto type = [](string expression, Options options = {}) {
+        return Evaluator(expression, {"x"}, options).getAST().getType();
+    };
+    EXPECT_EQ(type("x * 1"), AST::Type::VARIABLE);
+    EXPECT_EQ(type("x / 1"), AST::Type::VARIABLE);
+    EXPECT_EQ(type("x - 0"), AST::Type::VARIABLE);
+    EXPECT_EQ(type("-(-x)"), AST::Type::VARIABLE);
+    EXPECT_EQ(type("+x"), AST::Type::VARIABLE);
+    EXPECT_EQ(type("x ** 1"), AST::Type::VARIABLE);
+    // x may be an integer, which must not become a double
+    EXPECT_EQ(type("1.0 * x"), AST::Type::MUL);
+    // x may be -0.0, and -0.0 + 0 is 0.0
+    EXPECT_EQ(type("x + 0"), AST::Type::ADD);
+    EXPECT_EQ(type("x + 0", fast), AST::Type::VARIABLE);
+    EXPECT_EQ(type("sin(x) + (-0.0)"), AST::Type::FUNCTION);
+    // x may be a double, for which bitwise operators are an error
+    EXPECT_EQ(type("x << 0"), AST::Type::SHL);
+    EXPECT_EQ(type("~(~x)"), AST::Type::UnaryCOMP);
+    EXPECT_EQ(type("(x | 1) & -1"), AST::Type::OR);
+    EXPECT_EQ(type("(x & 7) << 0"), AST::Type::AND);
+    EXPECT_EQ(type("~(~(x ^ 3))"), AST::Type::XOR);
+
+    EXPECT_EQ(type("sin(x) ** 2"), AST::Type::POW);
+    EXPECT_EQ(type("sin(x) ** 2", fast), AST::Type::MUL);
+    EXPECT_EQ(type("pow(x, 0.5)"), AST::Type::FUNCTION);
+    Evaluator root("pow(x, 0.5)", {"x"}, fast);
+    EXPECT_EQ(static_cast<const FUNCTION&>(root.getAST()).getFunctionType(), FunctionType::sqrt);
+    EXPECT_EQ(type("x / 4.0"), AST::Type::MUL);
+    EXPECT_EQ(type("x / 4"), AST::Type::DIV);
+    EXPECT_EQ(type("sin(x) / 4"), AST::Type::MUL);
+    EXPECT_EQ(type("x / 3.0"), AST::Type::DIV);
+    EXPECT_EQ(type("x / 3.0", fast), AST::Type::MUL);
+    EXPECT_EQ(type("x * 8"), AST::Type::MUL);
+    EXPECT_EQ(type("(x & 255) * 8"), AST::Type::SHL);
+
+    Evaluator shift("(x & 255) * 8 + (x / 4.0)", {"x"});
+    EXPECT_EQ(shift.getRewrites().size(), 2);
+    EXPECT_EQ(shift.getRewrites()[0].name, "shift");
+    EXPECT_EQ(shift.getRewrites()[0].codeRef.str(), "(x & 255) * 8");
+    vector<variant<int64_t, double>> values{int64_t(-1000)};
+    EXPECT_EQ(std::get<double>(shift.get(values)), (-1000 & 255) * 8 + -1000 / 4.0);
+    values[0] = -0.0;
+    EXPECT_TRUE(signbit(std::get<double>(Evaluator("x - 0", {"x"}).get(values))));
+}
+
+TEST(Evaluator, TypeInference) {
+    auto type = [](string expression) {
+        return Evaluator(expression, {"i", "f", "a"}, {},
+                         {ValueType::integer, ValueType::floating, ValueType::any})
+            .getAST()
+            .getValueType();
+    };
+    EXPECT_EQ(type("i * 3 + i / 2"), ValueType::integer);
+    EXPECT_EQ(type("i * 3 + f"), ValueType::floating);
+    EXPECT_EQ(type("i + a"), ValueType::any);
+    EXPECT_EQ(type("f + a"), ValueType::floating);
+    EXPECT_EQ(type("a & 3"), ValueType::integer);
+    EXPECT_EQ(type("i ** 2"), ValueType::any);
+    EXPECT_EQ(type("abs(i) + popcount(a)"), ValueType::integer);
+    EXPECT_EQ(type("sin(i)"), ValueType::floating);
+
+    // declaring the types does not change any result
+    mt19937_64 generator(34);
+    for (string expression :
+         {"x * 3 + y / 2 - x % 7", "x / 3 + (y * y) - z", "(x & 12) ^ (~x << 2)", "-x * abs(y)",
+          "pow(x, 2) + pow(z, 3)", "sin(x) + sqrt(abs(z)) + x ** 3", "gcd(x, 12) * z / 4",
+          "exp(z) * exp(z) + x"}) {
+        Evaluator typed(expression, {"x", "y", "z"}, {},
+                        {ValueType::integer, ValueType::integer, ValueType::floating});
+        Evaluator untyped(expression, {"x", "y", "z"});
+        for (size_t i = 0; i < 100; ++i) {
+            vector<variant<int64_t, double>> values{int64_t(generator() % 2001) - 1000,
+                                                    int64_t(generator() % 2001) - 1000,
+                                                    (int64_t(generator() % 2001) - 1000) / 7.0};
+            EXPECT_EQ(typed.get(values), untyped.get(values)) << expression;
+        }
+    }
+
+    Evaluator evaluator("x * y", {"x", "y"}, {}, {ValueType::floating, ValueType::integer});
+    vector<variant<int64_t, double>> values{int64_t(3), int64_t(4)};
+    EXPECT_EQ(std::get<double>(evaluator.get(values)), 12.0);
+    vector<Column> columns{vector<int64_t>{1, 2}, vector<int64_t>{3, 4}};
+    EXPECT_EQ(std::get<vector<double>>(evaluator.get(columns, 2)), (vector<double>{3.0, 8.0}));
+    values[1] = 4.0;
+    EXPECT_EXIT(evaluator.get(values), testing::ExitedWithCode(1), "integer variable y");
+}
+
+static size_t depth(const AST& node) {
+    if (auto binary = dynamic_cast<const BinaryAST*>(&node)) {
+        return 1 + max(depth(binary->getLExpr()), depth(binary->getRExpr()));
+    }
+    if (auto unary = dynamic_cast<const UnaryAST*>(&node)) {
+        return 1 + depth(unary->getChild());
+    }
+    return 1;
+}
+
+TEST(Evaluator, Reassociation) {
+    string sum = "x";
+    string bits = "x";
+    for (int i = 1; i < 1024; ++i) {
+        sum += " + " + string(i % 2 ? "y" : "x") + " * " + to_string(i);
+        bits += " ^ (" + string(i % 2 ? "y" : "x") + " + " + to_string(i) + ")";
+    }
+    vector<ValueType> integers{ValueType::integer, ValueType::integer};
+    vector<variant<int64_t, double>> values{int64_t(3), int64_t(-7)};
+    for (auto& expression : {sum, bits}) {
+        Evaluator balanced(expression, {"x", "y"}, {}, integers);
+        EXPECT_EQ(balanced.getRewrites().back().name, "balance");
+        EXPECT_LE(depth(balanced.getAST()), 13);
+        Evaluator untyped(expression, {"x", "y"});
+        EXPECT_EQ(balanced.get(values), untyped.get(values));
+    }
+    // the types of untyped variables are unknown, so their sum is not rebalanced,
+    // bitwise operations always have integer results
+    EXPECT_EQ(depth(Evaluator(sum, {"x", "y"}).getAST()), 1025);
+    EXPECT_LE(depth(Evaluator(bits, {"x", "y"}).getAST()), 13);
+
+    vector<ValueType> doubles{ValueType::floating, ValueType::floating};
+    values = {0.1, 0.7};
+    Evaluator strict(sum, {"x", "y"}, {}, doubles);
+    EXPECT_TRUE(ranges::none_of(strict.getRewrites(),
+                                [](const Rewrite& rewrite) { return rewrite.name == "balance"; }));
+    EXPECT_EQ(depth(strict.getAST()), 1025);
+    Evaluator fast(sum, {"x", "y"}, {.fp = FloatPolicy::fast}, doubles);
+    EXPECT_LE(depth(fast.getAST()), 13);
+    EXPECT_NEAR(std::get<double>(fast.get(values)), std::get<double>(strict.get(values)), 1e-9);
+}
+
+static size_t powers(const AST& node) {
+    if (node.getType() == AST::Type::POW) {
+        return 1;
+    }
+    if (auto binary = dynamic_cast<const BinaryAST*>(&node)) {
+        return powers(binary->getLExpr()) + powers(binary->getRExpr());
+    }
+    if (auto unary = dynamic_cast<const UnaryAST*>(&node)) {
+        return powers(unary->getChild());
+    }
+    if (auto function = dynamic_cast<const FUNCTION*>(&node)) {
+        size_t count = function->getFunctionType() == FunctionType::pow;
+        for (auto& p : function->getParameters()) {
+            count += powers(*p);
+        }
+        return count;
+    }
+    return 0;
+}
+
+TEST(Evaluator, Horner) {
+    Options fast{.fp = FloatPolicy::fast};
+    auto isHorner = [](const Rewrite& rewrite) { return rewrite.name == "horner"; };
+    vector<string> variables{"x", "a", "b", "c", "d"};
+    vector<ValueType> types(5, ValueType::any);
+    types[0] = ValueType::floating;
+    for (string expression :
+         {"2.5 * (x ** 3) + 1.5 * (x ** 2) + 0.5 * x + 4",
+          "a * (x ** 3) + b * (x ** 2) + c * x + d", "2.5 * (x ** 2) - x - 1",
+          "x * 3 * x + x * a - pow(x, 4) * b",
+          "0.5 * (x ** 12) - 3 * (x ** 5) + (x ** 5) * d + x"}) {
+        Evaluator strict(expression, variables, {}, types);
+        Evaluator horner(expression, variables, fast, types);
+        EXPECT_TRUE(ranges::any_of(horner.getRewrites(), isHorner)) << expression;
+        EXPECT_EQ(powers(horner.getAST()), 0) << expression;
+        for (double x = -2; x <= 2; x += 0.125) {
+            vector<variant<int64_t, double>> values{x, 1.25, int64_t(-3), 0.75, int64_t(2)};
+            double expected = std::get<double>(strict.get(values));
+            EXPECT_NEAR(std::get<double>(horner.get(values)), expected, 1e-12 * abs(expected))
+                << expression << " at " << x;
+        }
+    }
+    // the gaps of a sparse polynomial share their powers
+    Evaluator sparse("0.5 * (y ** 12) + (y ** 6) + 1", {"y"}, fast);
+    EXPECT_GT(sparse.getSharingStatistics().deduplicated, 0);
+    EXPECT_NEAR(std::get<double>(sparse.get(vector<variant<int64_t, double>>{int64_t(2)})),
+                2048.0 + 64 + 1, 0);
+
+    // the rounding changes
+    EXPECT_EQ(powers(Evaluator("2.5 * (x ** 3) + x", {"x"}, {}, {ValueType::floating}).getAST()),
+              1);
+    // x may be an integer, for which x * x * x wraps around instead of promoting to a double
+    EXPECT_EQ(powers(Evaluator("3 * (x ** 3) + x", {"x"}, fast).getAST()), 1);
+    EXPECT_TRUE(
+        ranges::none_of(Evaluator("(x ** 2) + sin(x) * x", {"x"}, fast).getRewrites(), isHorner));
+}
+
+TEST(Evaluator, FloatPolicy) {
+    vector<string> variables{"x", "y", "z"};
+    vector<ValueType> types(3, ValueType::floating);
+    auto rewrites = [&](string expression, FloatPolicy fp) {
+        Evaluator evaluator(expression, variables, {.fp = fp}, types);
+        vector<string> names{};
+        for (auto& rewrite : evaluator.getRewrites()) {
+            names.emplace_back(rewrite.name);
+        }
+        return names;
+    };
+    using names = vector<string>;
+    EXPECT_EQ(rewrites("x * y + z", FloatPolicy::strict), names{});
+    EXPECT_EQ(rewrites("x * y + z", FloatPolicy::contract), names{"fma"});
+    EXPECT_EQ(rewrites("log(1 + x) + (x / 3.0)", FloatPolicy::contract), names{});
+    EXPECT_EQ(rewrites("log(1 + x) + (x / 3.0)", FloatPolicy::fast),
+              (names{"reciprocal", "log1p", "fma"}));
+    EXPECT_EQ(rewrites("x + y + z + x", FloatPolicy::contract), names{});
+    // an integer product is no double multiplication that could be contracted
+    EXPECT_TRUE(Evaluator("a * b + z", {"a", "b", "z"}, {.fp = FloatPolicy::contract},
+                          {ValueType::any, ValueType::any, ValueType::floating})
+                    .getRewrites()
+                    .empty());
+
+    vector<variant<int64_t, double>> values{0.1, 0.7, -0.07};
+    Evaluator strict("x * y + z", variables, {}, types);
+    Evaluator contract("x * y + z", variables, {.fp = FloatPolicy::contract}, types);
+    double x = 0.1, y = 0.7, z = -0.07;
+    EXPECT_EQ(std::get<double>(strict.get(values)), x * y + z);
+    EXPECT_EQ(std::get<double>(contract.get(values)), fma(x, y, z));
+
+    // the policy is part of the compiled expression and of its rewrites
+    EXPECT_EQ(contract.getOptions().fp, FloatPolicy::contract);
+    EXPECT_EQ(contract.getRewrites().front().policy, FloatPolicy::contract);
+    Evaluator fast("(x / 3.0) + (x * 8.0) / 2.0", variables, {.fp = FloatPolicy::fast}, types);
+    EXPECT_EQ(fast.getRewrites()[0].policy, FloatPolicy::fast);
+    EXPECT_EQ(fast.getRewrites()[1].policy, FloatPolicy::strict);
+    stringstream diagnostics;
+    diagnostics << contract.getOptions();
+    EXPECT_EQ(diagnostics.str(), "accuracy=standard overflow=promote fp=contract level=O2 backend=tree");
+}
+
+TEST(Evaluator, Specialization) {
+    Evaluator general("x * exp(-r * t) + k * (r ** 2) - n", {"x", "r", "t", "k", "n"}, {},
+                      {ValueType::floating, ValueType::floating, ValueType::any, ValueType::any,
+                       ValueType::integer});
+    auto specialized = general.specialize({{"r", int64_t(1)}, {"t", 0.5}});
+    EXPECT_EQ(specialized.getVariables(), (vector<string>{"x", "k", "n"}));
+    EXPECT_EQ(specialized.getTypes(),
+              (vector<ValueType>{ValueType::floating, ValueType::any, ValueType::integer}));
+    // exp(-r * t) is folded, the integer r is converted like when it is passed to get
+    auto& sum = static_cast<const BinaryAST&>(specialized.getAST());
+    auto& product = static_cast<const BinaryAST&>(sum.getLExpr());
+    EXPECT_EQ(product.getRExpr().getType(), AST::Type::VALUE);
+    EXPECT_EQ(static_cast<const VALUE&>(product.getRExpr()).asDouble(), exp(-0.5));
+    for (int64_t k = -3; k <= 3; ++k) {
+        vector<variant<int64_t, double>> all{0.25 * k, int64_t(1), 0.5, k, int64_t(7)};
+        vector<variant<int64_t, double>> remaining{0.25 * k, k, int64_t(7)};
+        EXPECT_EQ(specialized.get(remaining), general.get(all));
+    }
+    vector<Column> columns{vector<double>{1, 2}, vector<int64_t>{3, 4}, vector<int64_t>{5, 6}};
+    auto batch = std::get<vector<double>>(specialized.get(columns, 2));
+    EXPECT_EQ(batch[1], 2 * exp(-0.5) + (4.0 - 6));
+
+    // a specialization can be specialized again
+    auto constant = specialized.specialize({{"x", 2.0}, {"k", int64_t(3)}, {"n", int64_t(1)}});
+    EXPECT_EQ(constant.getAST().getType(), AST::Type::VALUE);
+    EXPECT_EQ(std::get<double>(constant.get()), 2 * exp(-0.5) + (3.0 - 1));
+
+    EXPECT_EXIT(general.specialize({{"n", 1.5}}), testing::ExitedWithCode(1), "integer variable n");
+    EXPECT_EXIT(general.specialize({{"y", 1.5}}), testing::ExitedWithCode(1), "unknown variable y");
+}
+
+TEST(Evaluator, BatchInvariants) {
+    Evaluator evaluator("x * exp(-r * t) + (n * 3 + 1) - pow(r, n)", {"x", "r", "t", "n"});
+    vector<Column> columns{vector<double>{1, 2, 3, 4}, vector<double>{0.05}, vector<double>{2.0},
+                           vector<int64_t>{2}};
+    auto result = std::get<vector<double>>(evaluator.get(columns, 4));
+    ASSERT_EQ(result.size(), 4);
+    for (size_t i = 0; i < 4; ++i) {
+        vector<variant<int64_t, double>> values{1.0 + i, 0.05, 2.0, int64_t(2)};
+        EXPECT_EQ(result[i], std::get<double>(evaluator.get(values)));
+    }
+    // an invariant result is repeated for every row
+    Evaluator invariant("exp(-r * t) + n", {"r", "t", "n"});
+    EXPECT_EQ(std::get<vector<double>>(invariant.get(span(columns).subspan(1), 3)),
+              vector<double>(3, exp(-0.1) + 2));
+    EXPECT_EQ(std::get<vector<int64_t>>(Evaluator("7").get({}, 2)), (vector<int64_t>{7, 7}));
+
+    columns[1] = vector<double>{0.05, 0.06};
+    EXPECT_EXIT(evaluator.get(columns, 4), testing::ExitedWithCode(1), "column size");
+}
+
+TEST(Evaluator, PassManager) {
+    auto names = [](const Evaluator& evaluator) {
+        vector<string> names{};
+        for (auto& pass : evaluator.getPassStatistics()) {
+            names.emplace_back(pass.name);
+        }
+        return names;
+    };
+    string expression = "exp(-r * t) * x + exp(-r * t) * (2 * 3)";
+    vector<string> variables{"x", "r", "t"};
+    Evaluator o0(expression, variables, {.level = OptimizationLevel::O0});
+    Evaluator o1(expression, variables, {.level = OptimizationLevel::O1});
+    Evaluator o2(expression, variables, {.fp = FloatPolicy::fast});
+    EXPECT_TRUE(names(o0).empty());
+    EXPECT_EQ(names(o1), (vector<string>{"fold", "simplify", "cse"}));
+    EXPECT_EQ(names(o2),
+              (vector<string>{"fold", "simplify", "horner", "reassociate", "idioms", "cse"}));
+    EXPECT_EQ(names(o1.specialize({{"r", 0.5}})),
+              (vector<string>{"specialize", "fold", "simplify", "cse"}));
+
+    auto& fold = o1.getPassStatistics()[0];
+    EXPECT_EQ(fold.nodesBefore, 17);
+    EXPECT_EQ(fold.nodesAfter, 15);
+    // the shared exp(-r * t) is counted once, plus a SHARED node for each occurrence
+    auto& cse = o1.getPassStatistics()[2];
+    EXPECT_EQ(cse.nodesBefore, 15);
+    EXPECT_EQ(cse.nodesAfter, 12);
+    vector<variant<int64_t, double>> values{1.5, 0.5, 2.0};
+    EXPECT_EQ(o0.get(values), o1.get(values));
+
+    stringstream dump;
+    Evaluator dumped("x * 1 + 2", {"x"}, {.level = OptimizationLevel::O1, .dump = &dump});
+    string input = "0 [label=\"+\"]\n0 -> 1\n1 [label=\"*\"]\n1 -> 2\n2 [label=\"x\"]\n"
+                   "1 -> 3\n3 [label=\"1i\"]\n0 -> 4\n4 [label=\"2i\"]\n";
+    string simplified = "0 [label=\"+\"]\n0 -> 1\n1 [label=\"x\"]\n0 -> 2\n2 [label=\"2i\"]\n";
+    EXPECT_EQ(dump.str(), "digraph \"input\" {\n" + input + "}\ndigraph \"fold\" {\n" + input +
+                              "}\ndigraph \"simplify\" {\n" + simplified +
+                              "}\ndigraph \"cse\" {\n" + simplified + "}\n");
+}
+
+// the same value, -0.0 differs from 0.0 and every NaN is the same, whatever its sign and payload
+static bool same(variant<int64_t, double> a, variant<int64_t, double> b) {
+    if (holds_alternative<int64_t>(a) || holds_alternative<int64_t>(b)) {
+        return a == b;
+    }
+    double l = std::get<double>(a), r = std::get<double>(b);
+    if (isnan(l) || isnan(r)) {
+        return isnan(l) && isnan(r);
+    }
+    return bit_cast<uint64_t>(l) == bit_cast<uint64_t>(r);
+}
+
+// evaluates some expressions with every kind of instruction with backend and the tree-walker
+static void expectSameAsTree(Backend backend, Retain retain = Retain::source) {
+    vector<string> variables{"x", "n", "a"};
+    vector<ValueType> types{ValueType::floating, ValueType::integer, ValueType::any};
+    vector<string> expressions{
+        "x * exp(-a * x) + n * 3 - a / 4",
+        "pow(a, n) + a ** 3 + n ** 40 + x ** n",
+        "n / 7 + n % 5 + a / 3 + a % 4 + x / 2 + x / 3 + n / a + x % a",
+        "fma(x, a, n) + hypot(x, a) + atan2(a, x) - sin(n) * erf(a)",
+        "sqrt(x * x + a * a) * sqrt(x * x + a * a) - -a + +n - -n",
+        "abs(a) + fmax(x, a) + remainder(a, 2) + copysign(n, x) + ilogb(x)",
+        "log(1 + x) + exp(x) - 1 + 2.5 * (x ** 3) + 1.5 * (x ** 2) + x + a * 2 / 8",
+        "n * n * n * n * n + a + a + a + a + a + x * x * x * x * x",
+        "exp(-x) * atan2(x, 2.5) + sqrt(x * x) + floor(x) + fmod(x, 1.5) + pow(x, 0.5) - x % 2",
+        "(n * 7 - 3) / 4 + (n << 3) - (n >> 1) + ~n + -n - n % 3 + a * n - a - -a"};
+    vector<vector<variant<int64_t, double>>> rows;
+    mt19937_64 generator(42);
+    uniform_real_distribution<double> real(-4, 4);
+    uniform_int_distribution<int64_t> integer(-20, 20);
+    for (size_t i = 0; i < 200; ++i) {
+        variant<int64_t, double> a = integer(generator);
+        if (i % 2) {
+            a = real(generator);
+        }
+        rows.push_back({real(generator), integer(generator), a});
+    }
+    rows.push_back({0.0, int64_t(0), int64_t(1)});
+    // n stays small, an overflow of n * 3 would be undefined and may differ between backends
+    rows.push_back({-0.0, int64_t(-7), numeric_limits<double>::quiet_NaN()});
+    for (auto& expression : expressions) {
+        for (Options options : {Options{}, Options{.accuracy = Accuracy::precise},
+                                Options{.fp = FloatPolicy::fast},
+                                Options{.level = OptimizationLevel::O0}}) {
+            Evaluator tree(expression, variables, options, types);
+            options.backend = backend;
+            options.retain = retain;
+            Evaluator compiled(expression, variables, options, types);
+            for (auto& row : rows) {
+                // integer division by zero
+                if (row[1] == variant<int64_t, double>(int64_t(0)) ||
+                    row[2] == variant<int64_t, double>(int64_t(0))) {
+                    continue;
+                }
+                ASSERT_TRUE(same(tree.get(row), compiled.get(row)))
+                    << expression << " " << options << " " << tree.get(row) << " "
+                    << compiled.get(row);
+            }
+        }
+    }
+}
+
+TEST(Evaluator, Bytecode) {
+    expectSameAsTree(Backend::bytecode);
+
+    vector<string> variables{"x", "n", "a"};
+    vector<ValueType> types{ValueType::floating, ValueType::integer, ValueType::any};
+    Options options{.backend = Backend::bytecode};
+    string bitwise = "(n & 255) ^ (a << 2) | ~n >> 1 + popcount(a) + gcd(n, 12)";
+    Evaluator bits(bitwise, variables, options, types);
+    Evaluator reference(bitwise, variables, {}, types);
+    for (int64_t a = -8; a <= 8; ++a) {
+        vector<variant<int64_t, double>> row{0.5, a * 3, a};
+        EXPECT_EQ(bits.get(row), reference.get(row));
+    }
+    vector<variant<int64_t, double>> row{0.5, int64_t(1), 1.5};
+    EXPECT_EXIT(bits.get(row), testing::ExitedWithCode(1), "bitwise operator on double");
+    EXPECT_EXIT(Evaluator("a ** 70", variables, {.overflow = OverflowPolicy::error,
+                                                 .backend = Backend::bytecode}, types)
+                    .get(vector<variant<int64_t, double>>{0.5, int64_t(1), int64_t(3)}),
+                testing::ExitedWithCode(1), "integer overflow");
+
+    // shared expressions, specializations and constant results
+    Evaluator shared("exp(-a * x) * n + exp(-a * x) * a", variables, options, types);
+    EXPECT_GT(shared.getSharingStatistics().expressions, 0);
+    vector<variant<int64_t, double>> values{0.5, int64_t(3), 2.0};
+    EXPECT_EQ(std::get<double>(shared.get(values)), exp(-1.0) * 3 + exp(-1.0) * 2);
+    auto specialized = shared.specialize({{"a", 2.0}});
+    EXPECT_EQ(specialized.get(vector<variant<int64_t, double>>{0.5, int64_t(3)}),
+              shared.get(values));
+    EXPECT_EQ(std::get<int64_t>(Evaluator("6 * 7", {}, options).get()), 42);
+    values[2] = int64_t(2);
+    EXPECT_EQ(std::get<double>(shared.get(values)), exp(-1.0) * 3 + exp(-1.0) * 2);
+}
+
+TEST(Evaluator, JIT) {
+    expectSameAsTree(Backend::jit);
+
+    vector<string> variables{"x", "n", "a"};
+    vector<ValueType> types{ValueType::floating, ValueType::integer, ValueType::any};
+    Evaluator jit("(n & 255) ^ (a << 2)", variables, {.backend = Backend::jit}, types);
+#if defined(__x86_64__)
+    EXPECT_EQ(jit.getBackend(), Backend::jit);
+#else
+    EXPECT_EQ(jit.getBackend(), Backend::bytecode);
+#endif
+    EXPECT_EQ(Evaluator("x", variables, {.backend = Backend::bytecode}, types).getBackend(),
+              Backend::bytecode);
+    EXPECT_EQ(Evaluator("x", variables, {}, types).getBackend(), Backend::tree);
+    vector<variant<int64_t, double>> row{0.5, int64_t(300), int64_t(3)};
+    EXPECT_EQ(std::get<int64_t>(jit.get(row)), (300 & 255) ^ (3 << 2));
+    row[2] = 1.5;
+    EXPECT_EXIT(jit.get(row), testing::ExitedWithCode(1), "bitwise operator on double");
+}
+
+TEST(Evaluator, Quickening) {
+    Evaluator evaluator("x * y + (x ** y)", {"x", "y"});
+    auto& sum = static_cast<const BinaryAST&>(evaluator.getAST());
+    auto& product = static_cast<const BinaryAST&>(sum.getLExpr());
+    EXPECT_EQ(sum.getQuickening(), Quickening::none);
+    vector<variant<int64_t, double>> doubles{1.5, 2.0};
+    EXPECT_EQ(std::get<double>(evaluator.get(doubles)), 1.5 * 2.0 + pow(1.5, 2.0));
+    EXPECT_EQ(sum.getQuickening(), Quickening::doubles);
+    EXPECT_EQ(product.getQuickening(), Quickening::doubles);
+    EXPECT_EQ(std::get<double>(evaluator.get(doubles)), 1.5 * 2.0 + pow(1.5, 2.0));
+    EXPECT_EQ(sum.getQuickening(), Quickening::doubles);
+
+    // other operand types deoptimize the node
+    vector<variant<int64_t, double>> mixed{int64_t(3), 2.0};
+    EXPECT_EQ(std::get<double>(evaluator.get(mixed)), 3 * 2.0 + pow(3, 2.0));
+    EXPECT_EQ(sum.getQuickening(), Quickening::doubles);
+    EXPECT_EQ(product.getQuickening(), Quickening::generic);
+    vector<variant<int64_t, double>> integers{int64_t(3), int64_t(2)};
+    EXPECT_EQ(std::get<int64_t>(evaluator.get(integers)), 3 * 2 + 9);
+    EXPECT_EQ(sum.getQuickening(), Quickening::generic);
+    EXPECT_EQ(std::get<double>(evaluator.get(doubles)), 1.5 * 2.0 + pow(1.5, 2.0));
+
+    Evaluator quickened("x * y - y", {"x", "y"});
+    EXPECT_EQ(std::get<double>(quickened.get(mixed)), 3 * 2.0 - 2.0);
+    auto& difference = static_cast<const BinaryAST&>(quickened.getAST());
+    EXPECT_EQ(difference.getQuickening(), Quickening::doubles);
+    EXPECT_EQ(static_cast<const BinaryAST&>(difference.getLExpr()).getQuickening(),
+              Quickening::integerDouble);
+    EXPECT_EQ(std::get<int64_t>(quickened.get(integers)), 3 * 2 - 2);
+    EXPECT_EQ(difference.getQuickening(), Quickening::generic);
+
+    // specializations share subexpressions with their Evaluator, both quicken them concurrently
+    Evaluator shared("x * y + x * y + z", {"x", "y", "z"});
+    EXPECT_GT(shared.getSharingStatistics().expressions, 0);
+    Evaluator specialized = shared.specialize({{"z", int64_t(1)}});
+    auto run = [](Evaluator& evaluator, vector<variant<int64_t, double>> row,
+                  variant<int64_t, double> expected) {
+        for (int i = 0; i < 20000; ++i) {
+            if (evaluator.get(row) != expected) {
+                return false;
+            }
+        }
+        return true;
+    };
+    bool integral = false;
+    thread other([&] {
+        integral = run(shared, {int64_t(3), int64_t(2), int64_t(1)}, int64_t(13));
+    });
+    EXPECT_TRUE(run(specialized, {1.5, 2.0}, 7.0));
+    other.join();
+    EXPECT_TRUE(integral);
+}
+
+TEST(Evaluator, Tiered) {
+    vector<string> variables{"x", "n", "a"};
+    vector<ValueType> types{ValueType::floating, ValueType::integer, ValueType::any};
+    string expression = "x * exp(-a * x) + n * 3 - a / 4 + (n << 2) + 2 * 3";
+    Evaluator reference(expression, variables, {}, types);
+    Evaluator tiered(expression, variables, {.backend = Backend::tiered, .threshold = 10}, types);
+    EXPECT_EQ(tiered.getBackend(), Backend::tree);
+    EXPECT_EQ(tiered.getPassStatistics().size(), 0);
+    auto row = [](int64_t i) {
+        variant<int64_t, double> a = i % 2 ? variant<int64_t, double>(i) : 0.5;
+        return vector<variant<int64_t, double>>{0.25 * double(i), i, a};
+    };
+    for (int64_t i = 0; i < 9; ++i) {
+        EXPECT_TRUE(same(tiered.get(row(i)), reference.get(row(i))));
+    }
+    EXPECT_EQ(tiered.getTierStatistics().evaluations, 9);
+    EXPECT_EQ(tiered.getTierStatistics().promotedAfter, 0);
+    EXPECT_TRUE(same(tiered.get(row(9)), reference.get(row(9))));
+    EXPECT_EQ(tiered.getTierStatistics().promotedAfter, 10);
+
+    // the compilation runs on a copy, the Evaluator can be moved and evaluates meanwhile
+    Evaluator moved = std::move(tiered);
+    int64_t i = 10;
+    for (; i < 100000 && !moved.getTierStatistics().promoted; ++i) {
+        EXPECT_TRUE(same(moved.get(row(i)), reference.get(row(i))));
+        this_thread::sleep_for(chrono::microseconds(100));
+    }
+    auto statistics = moved.getTierStatistics();
+    EXPECT_TRUE(statistics.promoted);
+    EXPECT_EQ(statistics.evaluations, i);
+    EXPECT_GT(statistics.time.count(), 0);
+#if defined(__x86_64__)
+    EXPECT_EQ(moved.getBackend(), Backend::jit);
+#else
+    EXPECT_EQ(moved.getBackend(), Backend::bytecode);
+#endif
+    for (int64_t k = 0; k < 100; ++k) {
+        EXPECT_TRUE(same(moved.get(row(k)), reference.get(row(k))));
+    }
+    vector<Column> columns{vector<double>{0.5, 1.5}, vector<int64_t>{1, 2}, vector<double>{2.0}};
+    EXPECT_EQ(std::get<vector<double>>(moved.get(columns, 2)),
+              std::get<vector<double>>(reference.get(columns, 2)));
+    EXPECT_EQ(moved.getTierStatistics().evaluations, i + 102);
+
+    // an Evaluator can be destroyed while it is compiled or waits for its compilation
+    Evaluator destroyed(expression, variables, {.backend = Backend::tiered, .threshold = 1}, types);
+    destroyed.get(row(1));
+
+    // the promotions share one background thread, which compiles them one after another
+    vector<Evaluator> hot;
+    for (int64_t k = 0; k < 64; ++k) {
+        hot.emplace_back(expression + " + " + to_string(k), variables,
+                         Options{.backend = Backend::tiered, .threshold = 1}, types);
+        hot.back().get(row(k));
+    }
+    for (int64_t k = 0; k < 64; ++k) {
+        for (size_t wait = 0; wait < 100000 && !hot[k].getTierStatistics().promoted; ++wait) {
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+        EXPECT_TRUE(hot[k].getTierStatistics().promoted);
+        Evaluator expected(expression + " + " + to_string(k), variables, {}, types);
+        EXPECT_TRUE(same(hot[k].get(row(k)), expected.get(row(k))));
+    }
+}
+
+TEST(Evaluator, Retain) {
+    expectSameAsTree(Backend::bytecode, Retain::offsets);
+    expectSameAsTree(Backend::jit, Retain::none);
+
+    vector<string> variables{"x", "n", "a"};
+    vector<ValueType> types{ValueType::floating, ValueType::integer, ValueType::any};
+    Options options{.overflow = OverflowPolicy::error, .backend = Backend::jit};
+    string expression = "x + (a ** 70) + (n & a)";
+    Evaluator source(expression, variables, options, types);
+    options.retain = Retain::offsets;
+    Evaluator offsets(expression, variables, options, types);
+    options.retain = Retain::none;
+    Evaluator none(expression, variables, options, types);
+    // the sites are the power and the checks of the bitwise operands
+    auto& locations = offsets.getLocations();
+    ASSERT_EQ(locations.size(), 2);
+    EXPECT_EQ(locations[0].offset, 5);
+    EXPECT_EQ(locations[0].size, 7);
+    EXPECT_EQ(locations[1].offset, 17);
+    EXPECT_EQ(locations[1].size, 5);
+    EXPECT_EQ(source.getLocations().size(), 2);
+    EXPECT_TRUE(none.getLocations().empty());
+
+    vector<variant<int64_t, double>> row{0.5, int64_t(3), int64_t(1)};
+    EXPECT_TRUE(same(none.get(row), source.get(row)));
+    row[2] = 1.5;
+    EXPECT_EXIT(source.get(row), testing::ExitedWithCode(1), "\\^\\^\\^\\^\\^");
+    EXPECT_EXIT(offsets.get(row), testing::ExitedWithCode(1), "offset: 17 with length: 5");
+    EXPECT_EXIT(none.get(row), testing::ExitedWithCode(1), "bitwise operator on double at site 1");
+    row[2] = int64_t(3);
+    EXPECT_EXIT(offsets.get(row), testing::ExitedWithCode(1), "offset: 5 with length: 7");
+    EXPECT_EXIT(none.get(row), testing::ExitedWithCode(1), "overflow in exponentiation at site 0");
+
+    // the source and the AST are gone, so is what needs them
+    EXPECT_EXIT(none.getAST(), testing::ExitedWithCode(1), "does not keep the AST");
+    EXPECT_EXIT(offsets.specialize({{"a", 2.0}}), testing::ExitedWithCode(1), "specializing");
+    vector<Column> columns{vector<double>{0.5}, vector<int64_t>{1}, vector<int64_t>{2}};
+    EXPECT_EXIT(none.get(columns, 1), testing::ExitedWithCode(1), "columns need the AST");
+    // the rewrites keep their offsets without the source
+    Options fast{.fp = FloatPolicy::fast, .backend = Backend::bytecode};
+    Evaluator rewritten("log(1 + x) + x * 1", {"x"}, fast);
+    fast.retain = Retain::none;
+    Evaluator stripped("log(1 + x) + x * 1", {"x"}, fast);
+    auto& rewrites = stripped.getRewrites();
+    ASSERT_EQ(rewrites.size(), rewritten.getRewrites().size());
+    ASSERT_EQ(rewrites.size(), 2);
+    EXPECT_EQ(rewritten.getRewrites()[0].codeRef.str(), "x * 1");
+    for (size_t i = 0; i < rewrites.size(); ++i) {
+        EXPECT_EQ(rewrites[i].name, rewritten.getRewrites()[i].name);
+        EXPECT_EQ(rewrites[i].policy, rewritten.getRewrites()[i].policy);
+        EXPECT_EQ(rewrites[i].codeRef.getFrom(), rewritten.getRewrites()[i].codeRef.getFrom());
+        EXPECT_EQ(rewrites[i].codeRef.getTo(), rewritten.getRewrites()[i].codeRef.getTo());
+        EXPECT_TRUE(rewrites[i].codeRef.str().empty());
+    }
+    // tree evaluates the AST
+    Evaluator tree(expression, variables, {.retain = Retain::none}, types);
+    EXPECT_EQ(tree.getBackend(), Backend::tree);
+    EXPECT_EQ(tree.getAST().getType(), source.getAST().getType());
+}
+
+TEST(Evaluator, Allocations) {
+    vector<string> variables{"x", "n", "a"};
+    vector<ValueType> types{ValueType::floating, ValueType::integer, ValueType::any};
+    vector<string> expressions{
+        "x * exp(-a * x) + n * 3 - a / 4",
+        "pow(a, n) + a ** 3 + n ** 40 + x ** n + fma(x, a, n) + hypot(x, a)",
+        "n / 7 + n % 5 + a / 3 + a % 4 + x % a + gcd(n, 12) + popcount(n) + ilogb(x)",
+        "sqrt(x * x + a * a) * sqrt(x * x + a * a) + (n << 3) - (n >> 1) + ~n"};
+    vector<variant<int64_t, double>> doubles{0.5, int64_t(3), 2.5};
+    vector<variant<int64_t, double>> integers{0.5, int64_t(3), int64_t(2)};
+    for (auto backend : {Backend::tree, Backend::bytecode, Backend::jit, Backend::tiered}) {
+        for (auto options : {Options{.backend = backend},
+                             Options{.accuracy = Accuracy::precise, .backend = backend},
+                             Options{.level = OptimizationLevel::O0, .backend = backend}}) {
+            options.threshold = 10;
+            cout << "allocations per compile with " << options << ":";
+            for (auto& expression : expressions) {
+                optional<Evaluator> evaluator;
+                size_t compile = allocationsOf(
+                    [&] { evaluator.emplace(expression, variables, options, types); });
+                // the promotion of tiered compiles the expression
+                for (int i = 0; i < 20; ++i) {
+                    evaluator->get(doubles);
+                }
+                while (backend == Backend::tiered && !evaluator->getTierStatistics().promoted) {
+                    this_thread::yield();
+                }
+                size_t evaluation = allocationsOf([&] {
+                    for (int i = 0; i < 100; ++i) {
+                        evaluator->get(doubles);
+                        evaluator->get(integers);
+                    }
+                });
+                EXPECT_EQ(evaluation, 0) << expression << " " << options;
+                cout << " " << compile;
+            }
+            cout << endl;
+        }
+    }
+}
+
+TEST(Evaluator, AheadOfTime) {
+    // functions of integers are evaluated at compile time
+    static_assert(generated::constant() == 42);
+    constexpr int64_t bits = generated::bits(3, 5);
+    Evaluator reference("(n * n + 3 * n - 7) % 1000 + (n << 2) ^ (m >> 1) | ~m & 255", {"n", "m"},
+                        {}, {ValueType::integer, ValueType::integer});
+    vector<variant<int64_t, double>> integers{int64_t(3), int64_t(5)};
+    EXPECT_EQ(std::get<int64_t>(reference.get(integers)), bits);
+
+    Evaluator decay("x * exp(-r * t) + n * 3 - r / 4", {"x", "n", "r", "t"}, {},
+                    {ValueType::floating, ValueType::integer, ValueType::floating,
+                     ValueType::floating});
+    Evaluator polynomial("2.5 * (x ** 3) + 1.5 * (x ** 2) - 4 * x + 7 + x * x * n - x / 3",
+                         {"x", "n"}, {}, {ValueType::floating, ValueType::integer});
+    Evaluator mixed("(x + n) * (x + n) - x / 4 + n % 7 + 2 ** n + abs(x - n) + gcd(n, 12)",
+                    {"x", "n"});
+    Evaluator functions("hypot(x, y) + atan2(y, x) + fmod(x, 1.5) + sqrt(x * x + 1) + fmax(x, y)",
+                        {"x", "y"}, {}, {ValueType::floating, ValueType::floating});
+    mt19937_64 generator(42);
+    uniform_real_distribution<double> real(-4, 4);
+    uniform_int_distribution<int64_t> integer(-20, 20);
+    for (size_t i = 0; i < 200; ++i) {
+        double x = real(generator);
+        double r = real(generator);
+        int64_t n = integer(generator);
+        int64_t m = integer(generator);
+        vector<variant<int64_t, double>> row{x, n, r, 0.5};
+        EXPECT_TRUE(same(generated::decay(x, n, r, 0.5), decay.get(row)));
+        EXPECT_TRUE(same(generated::polynomial(x, n),
+                         polynomial.get(vector<variant<int64_t, double>>{x, n})));
+        EXPECT_TRUE(same(generated::functions(x, r),
+                         functions.get(vector<variant<int64_t, double>>{x, r})));
+        EXPECT_EQ(generated::bits(n, m),
+                  std::get<int64_t>(reference.get(vector<variant<int64_t, double>>{n, m})));
+        // variables without a type can hold either type
+        for (variant<int64_t, double> a : {variant<int64_t, double>(x), {m}}) {
+            vector<variant<int64_t, double>> values{a, m};
+            EXPECT_TRUE(same(generated::mixed(a, m), mixed.get(values)));
+        }
+    }
+    EXPECT_EQ(generated::masked(int64_t(300), 3), (300 & 255) ^ 3);
+    EXPECT_EXIT(generated::masked(1.5, 3), testing::ExitedWithCode(1),
+                "bitwise operator on double");
+}
+
+TEST(Evaluator, ConstantEvaluation) {
+    using namespace evaluate::literals;
+    // ** binds loosest, so this is 2 ** 60
+    static_assert(ce_eval("2 ** 20 * 3") == variant<int64_t, double>(int64_t(1) << 60));
+    static_assert("2 ** 10 * 1.5"_eval == 1 << 15);
+    static_assert("0.1"_eval == 0.1 && "10 - 2 - 3"_eval == 11);
+    static_assert(is_same_v<decltype("2 ** 64"_eval), double>);
+    static_assert("9007199254740993.0"_eval == 9007199254740992.0);
+    static_assert("0.30000000000000001665334536937734810635447502136230468750001"_eval ==
+                  0.30000000000000004);
+    static_assert("popcount(255) + gcd(12, 18) + modpow(3, 4, 5) + div(7, 2)"_eval == 18);
+    constexpr double functions = "sqrt(2) * sin(0.5) + hypot(3, 4) ** 0.5"_eval;
+    EXPECT_EQ(functions, pow(sqrt(2) * sin(0.5) + hypot(3, 4), 0.5));
+    for (const char* expression :
+         {"2 ** 20 * 1.5", "8 / 2 / 2", "2 ** 3 ** 2", "-2 ** 2", "2 ** -1", "2 ** 70",
+          "~5 & 3 | 8 ^ 1", "1 << 3 >> 1", "7 % 3 - 7.5 % 2", "abs(-3) + fmax(1, 2.5)",
+          "exp(1) * log(10) - cbrt(27)", "3.14159 * 2 ** 0.5", "0.1 + 0.2", "pow(2, 62)",
+          "pow(2, 64)", "+-~3", "ceil(1.5) + floor(-1.5) + trunc(2.7) + round(2.5)",
+          "bextract(255, 2, 3) * fma(2, 3, 4)", ".5 + 5.", "123456789.123456789012345678901"}) {
+        EXPECT_TRUE(same(ce_eval(expression), eval(expression))) << expression;
+    }
+    EXPECT_EXIT(ce_eval("1 + x"), testing::ExitedWithCode(1), "unknown variable x");
+    EXPECT_EXIT(ce_eval("(1 + 2"), testing::ExitedWithCode(1), "no more tokens");
+    EXPECT_EXIT(ce_eval("sin(1, 2)"), testing::ExitedWithCode(1), "number of parameters");
+}
+
+TEST(Evaluator, ExpressionTemplates) {
+    constexpr auto bits = compile<"(n * n + 3 * n - 7) % 1000 + (n << 2) ^ (m >> 1) | ~m & 255">();
+    static_assert(bits.arity == 2 && bits(3, 5) == generated::bits(3, 5));
+    static_assert(is_same_v<decltype(bits(3, 5)), int64_t>);
+    auto decay = compile<"x * exp(-r * t) + n * 3 - r / 4", "x", "n", "r", "t">();
+    auto polynomial = compile<"2.5 * (x ** 3) + 1.5 * (x ** 2) - 4 * x + 7 + x * x * n - x / 3">();
+    auto mixed = compile<"(x + n) * (x + n) - x / 4 + n % 7 + 2 ** n + abs(x - n) + gcd(n, 12)">();
+    auto functions = compile<"a * x + sin(b) + hypot(x, b) + fmod(x, 1.5) + pow(a, 2)">();
+    static_assert(is_same_v<decltype(polynomial(1.5, 2)), double>);
+    static_assert(is_same_v<decltype(mixed(variant<int64_t, double>(1.5), 2)),
+                            variant<int64_t, double>>);
+    Evaluator decayReference("x * exp(-r * t) + n * 3 - r / 4", {"x", "n", "r", "t"}, {},
+                             {ValueType::floating, ValueType::integer, ValueType::floating,
+                              ValueType::floating});
+    Evaluator polynomialReference("2.5 * (x ** 3) + 1.5 * (x ** 2) - 4 * x + 7 + x * x * n - x / 3",
+                                  {"x", "n"}, {}, {ValueType::floating, ValueType::integer});
+    Evaluator mixedReference(
+        "(x + n) * (x + n) - x / 4 + n % 7 + 2 ** n + abs(x - n) + gcd(n, 12)", {"x", "n"});
+    Evaluator functionsReference("a * x + sin(b) + hypot(x, b) + fmod(x, 1.5) + pow(a, 2)",
+                                 {"a", "x", "b"});
+    mt19937_64 generator(42);
+    uniform_real_distribution<double> real(-4, 4);
+    uniform_int_distribution<int64_t> integer(-70, 70);
+    for (size_t i = 0; i < 200; ++i) {
+        double x = real(generator);
+        double r = real(generator);
+        int64_t n = integer(generator);
+        int64_t m = integer(generator);
+        vector<variant<int64_t, double>> row{x, n, r, 0.5};
+        EXPECT_TRUE(same(decay(x, n, r, 0.5), decayReference.get(row)));
+        EXPECT_TRUE(same(polynomial(x, n),
+                         polynomialReference.get(vector<variant<int64_t, double>>{x, n})));
+        // variables without a type can hold either type, 2 ** n overflows for n > 62
+        for (variant<int64_t, double> a : {variant<int64_t, double>(x), {m}}) {
+            vector<variant<int64_t, double>> values{a, n};
+            EXPECT_TRUE(same(mixed(a, n), mixedReference.get(values)));
+            EXPECT_TRUE(same(functions(a, x, r),
+                             functionsReference.get(vector<variant<int64_t, double>>{a, x, r})));
+            EXPECT_TRUE(same(functions(n, x, m),
+                             functionsReference.get(vector<variant<int64_t, double>>{n, x, m})));
+        }
+    }
+    EXPECT_EXIT(compile<"x & 255">()(variant<int64_t, double>(1.5)), testing::ExitedWithCode(1),
+                "bitwise operator on double");
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}